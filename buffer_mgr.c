@@ -1,248 +1,2044 @@
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
 #include "buffer_mgr.h"
 #include "storage_mgr.h"
+#include "storage_mgr_async.h"
+#include "buffer_mgr_policy.h"
 #include <math.h>
 
+// The background writer checks the partitions at least this often, and whenever a client had to write back a victim
+#define WRITER_INTERVAL_MS 10
+
+// Number of prefetch requests that can wait for the prefetcher, further requests are dropped
+#define PREFETCH_QUEUE_SIZE 16
+
 // Representation of a Page Frame in buffer pool (memory).
 typedef struct Page
 {
 	SM_PageHandle data;
 	PageNumber pageNum;
 	bool isPageDirty;
-	// number of clients accessing a given page at a given instance
+	// number of clients accessing a given page at a given instance, only changed with atomic operations
 	int clientCount;
-	int hitNumber;
-	int refNumber;
+	// next frame in the same bucket of the page table, -1 at the end of the chain
+	int hashNext;
+	// the page is still being read from disk, clients asking for it wait on frameLoaded
+	bool isLoading;
+	// page evicted from this frame whose write-back is still in flight, NO_PAGE if there is none
+	PageNumber writeBackPageNum;
+	// next frame in the same bucket of the write-back table, -1 at the end of the chain
+	int writeBackNext;
+	// latch of the page contents, see latchPage. It is allocated on its own, as frames move when the pool is resized.
+	pthread_rwlock_t *latch;
+	// accessClock of the partition when the page was last loaded or pinned, orders the pages of the warm start file
+	unsigned long lastAccess;
+	// the page was read by a prefetch and has not been pinned since
+	bool isPrefetched;
 } PageFrame;
 
-// bufferSize denotes the size of the buffer pool, denoting how much page frames can be stored in the buffer pool
-int bufferSize = 0;
-
-// "numPagesReadCount" basically stores the count of number of pages read from the disk, used to calculate current Index
-int numPagesReadCount = 0;
-
-// "totalDiskWriteCount" counts the number of I/O write to the disk i.e. number of pages writen to the disk
-int totalDiskWriteCount = 0;
+// One partition of a buffer pool: a share of the frames with its own page table, replacement state and latch.
+// Every page belongs to one partition (chosen by its page number), frames are indexed within their partition.
+typedef struct PoolPartition
+{
+	// the page frames of the partition. The array is replaced when the pool is resized, so a frame is only accessed with
+	// the partition latch held; code that releases the latch for I/O finds the frame again through the page table.
+	PageFrame *pageFrames;
+	int numFrames;
+	// guards the page table, the replacement state, which page a frame holds, the dirty flags and the
+	// counters of the partition. It is only held for this bookkeeping, never while waiting for I/O.
+	pthread_mutex_t partitionLatch;
+	// broadcast whenever a frame finished loading or a write-back of an evicted page finished
+	pthread_cond_t frameLoaded;
+	// page table: hash buckets holding the index of the first frame of their chain (-1 if empty),
+	// the chains are linked through PageFrame.hashNext. The bucket count is a power of two.
+	int *pageTable;
+	int pageTableMask;
+	// write-back table: the frames whose evicted page is still being written back, found under that page
+	// (PageFrame.writeBackPageNum) through chains linked by PageFrame.writeBackNext. It has the buckets of the page table.
+	int *writeBackTable;
+	// stack of the frames that hold no page, the frame on top is used first
+	int *freeFrames;
+	int numFreeFrames;
+	// number of frames holding a clean page nobody uses or loads (see isCleanFrame), kept up to date by every change of
+	// a frame's fix count, dirty flag or loading flag, so that the background writer does not have to count them
+	int numCleanFrames;
+	// number of evicted pages whose write-back is still in flight
+	int numWriteBacks;
+	// counts the loads and pins of the partition's pages, see PageFrame.lastAccess
+	unsigned long accessClock;
+	// page buffer that is not owned by any frame, a miss reads into it while the victim is written back
+	SM_PageHandle spareData;
+	// "numPagesReadCount" basically stores the count of number of pages read from the disk for pins, the pages read by
+	// prefetches are counted in stats.prefetchedPages
+	long numPagesReadCount;
+	// "totalDiskWriteCount" counts the number of I/O write to the disk i.e. number of pages writen to the disk
+	long totalDiskWriteCount;
+	// statistics of the partition's pages, see getPoolStats. All counters are changed with relaxed atomic adds (see
+	// addCount), so that they are read without the partition latch.
+	BM_PoolStats stats;
+	// state the replacement policy keeps about the frames, and the pool handle the policy gets:
+	// its mgmtData points back to the partition and numPages is the number of frames of the partition
+	void *policyData;
+	BM_BufferPool policyView;
+} PoolPartition;
+
+// A page being read into a frame reserved for it, see loadReservedFrames
+typedef struct FrameLoad
+{
+	PoolPartition *partition;
+	PageNumber pageNum;
+	// dirty page evicted from the frame that is written back first, NO_PAGE if there is none
+	PageNumber evictedPageNum;
+	// buffer of the frame, and the page's buffer once it was read (the mapping of a zero-copy pool)
+	SM_PageHandle evictedData;
+	SM_PageHandle data;
+	// result of the write-back of the evicted page and of the read
+	RC writeResult;
+	RC result;
+} FrameLoad;
 
-// "hit" is incremented whenever a page frame is added into the buffer pool, used in LRU strategy
-int hit = 0;
+// A dirty page taken by collectDirtyFrames, written back by writeDirtyFrames
+typedef struct DirtyPage
+{
+	PoolPartition *partition;
+	PageNumber pageNum;
+	SM_PageHandle data;
+} DirtyPage;
 
-// "clockPointer" tracks on to the last added page in the buffer pool.
-int clockPointer = 0;
+// Page buffers allocated in one piece, aligned so that they can be used for O_DIRECT transfers
+typedef struct FrameSlab
+{
+	char *buffers;
+	int numBuffers;
+	// number of its buffers in the pool's list of unused buffers, the slab is released once all of them are
+	int numUnused;
+	struct FrameSlab *next;
+} FrameSlab;
+
+// Book-keeping of one buffer pool, stored in bm->mgmtData
+typedef struct PoolInfo
+{
+	// the partitions of the pool, the frames of getFrameContents are those of one partition after the other
+	PoolPartition *partitions;
+	int numPartitions;
+	// handle of the page file, kept open for the lifetime of the pool
+	SM_FileHandle fileHandle;
+	// serializes the storage manager calls that change the file handle or the file's book-keeping (growing the file,
+	// checksummed, compressed and mapped pages). Positional transfers of plain pages run without it, see takeFileHandle.
+	pthread_mutex_t fileLatch;
+	// frames point into a read-only mapping of the page file instead of holding their own copy
+	bool zeroCopy;
+	// stratData passed to initBufferPool was not NULL. It is not kept, it may point to the caller's stack: a resize
+	// creates the policy states through initFrom, or through init with NULL if stratData was NULL.
+	bool hasStratData;
+	// serializes resizeBufferPool calls
+	pthread_mutex_t resizeLatch;
+	// page buffers of the frames and the spare buffers: one slab allocated with the pool and one more for every resize
+	// that grows it (none for zero-copy pools). Buffers of frames a shrink dropped wait in unusedBuffers for the next
+	// grow, a slab whose buffers are all unused is released. Changed only with resizeLatch held or without any client.
+	FrameSlab *frameSlabs;
+	SM_PageHandle *unusedBuffers;
+	int numUnusedBuffers;
+	int numSlabBuffers;
+	// I/O engine used to overlap page reads with write-backs, NULL if only synchronous I/O is available
+	SM_AsyncContext *asyncContext;
+	// replacement policy of the pool (see buffer_mgr_policy.h), every partition keeps its own state of it
+	const BM_ReplacementPolicy *policy;
+	// background writer: keeps cleanFramesPercent of the frames of every partition clean and unpinned.
+	// writerLatch guards stopWriter and writerWakeupPending, writerWakeup wakes the writer up before its interval passed.
+	int cleanFramesPercent;
+	bool isWriterRunning;
+	pthread_t writerThread;
+	pthread_mutex_t writerLatch;
+	pthread_cond_t writerWakeup;
+	bool stopWriter;
+	bool writerWakeupPending;
+	// prefetcher: reads the pages of the ranges in prefetchQueue into the pool, started by the first prefetch request.
+	// A request with prefetchLoads set holds frames already reserved through an access strategy, only their reads are left.
+	// prefetchLatch guards the queue and stopPrefetcher.
+	bool isPrefetcherRunning;
+	pthread_t prefetchThread;
+	pthread_mutex_t prefetchLatch;
+	pthread_cond_t prefetchWakeup;
+	bool stopPrefetcher;
+	PageNumber prefetchStart[PREFETCH_QUEUE_SIZE];
+	int prefetchCount[PREFETCH_QUEUE_SIZE];
+	FrameLoad *prefetchLoads[PREFETCH_QUEUE_SIZE];
+	int prefetchHead;
+	int prefetchLength;
+	// read-ahead: once readAheadPages > 0 and three adjacent pages were pinned one after the other, the next readAheadPages
+	// pages are prefetched. The last page pinned, the length of the run and the end of the pages requested so far are
+	// changed with atomic operations, clients racing on them at worst start a read-ahead too early or too late.
+	int readAheadPages;
+	PageNumber lastPinnedPage;
+	int sequentialPins;
+	PageNumber readAheadEnd;
+	// warm start: file the pages in the pool are listed in at shutdown (NULL if there is none), and the pages listed
+	// in it at init that the prefetcher still has to read
+	char *warmStartFile;
+	PageNumber *warmPages;
+	int numWarmPages;
+} BufferPoolInfo;
 
 // ***** HELPER FUNCTIONS ***** //
 #pragma region HELPER FUNCTIONS
 
-// writeBlockToDisk method implemented
-extern void writeBlockToDisk(BM_BufferPool *const bm, PageFrame *pageFrame, int pageFrameIndex)
+// Bucket of a hash table with mask + 1 buckets that holds page pageNum
+static int hashPageNumber(const PageNumber pageNum, int mask)
 {
-	SM_FileHandle fh;
-	openPageFile(bm->pageFile, &fh);
+	unsigned int hash = (unsigned int)pageNum * 2654435761u;
+	return (int)(hash & (unsigned int)mask);
+}
+
+// Returns the partition page pageNum belongs to. It is chosen by the high bits of the hash, the page tables use the low bits.
+static PoolPartition *getPartition(BufferPoolInfo *poolInfo, const PageNumber pageNum)
+{
+	unsigned int hash = (unsigned int)pageNum * 2654435761u;
+	return &poolInfo->partitions[(hash >> 16) % (unsigned int)poolInfo->numPartitions];
+}
+
+// Takes the latches of all partitions, in the order of the partitions so that two callers cannot deadlock
+static void lockPartitions(BufferPoolInfo *poolInfo)
+{
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+		pthread_mutex_lock(&poolInfo->partitions[iter].partitionLatch);
+}
+
+// Releases the latches taken by lockPartitions
+static void unlockPartitions(BufferPoolInfo *poolInfo)
+{
+	int iter;
+	for (iter = poolInfo->numPartitions - 1; iter >= 0; iter--)
+		pthread_mutex_unlock(&poolInfo->partitions[iter].partitionLatch);
+}
+
+// Returns the index of the frame holding page pageNum, -1 if the page is not in the partition
+static int findFrame(PoolPartition *partition, const PageNumber pageNum)
+{
+	int frameIndex = partition->pageTable[hashPageNumber(pageNum, partition->pageTableMask)];
+	while (frameIndex != -1 && partition->pageFrames[frameIndex].pageNum != pageNum)
+		frameIndex = partition->pageFrames[frameIndex].hashNext;
+	return frameIndex;
+}
+
+// Adds the frame to the page table under the page it holds
+static void insertFrame(PoolPartition *partition, int frameIndex)
+{
+	int bucket = hashPageNumber(partition->pageFrames[frameIndex].pageNum, partition->pageTableMask);
+	partition->pageFrames[frameIndex].hashNext = partition->pageTable[bucket];
+	partition->pageTable[bucket] = frameIndex;
+}
+
+// Removes the frame from the page table, called before the frame gets another page
+static void removeFrame(PoolPartition *partition, int frameIndex)
+{
+	int *link = &partition->pageTable[hashPageNumber(partition->pageFrames[frameIndex].pageNum, partition->pageTableMask)];
+	while (*link != -1 && *link != frameIndex)
+		link = &partition->pageFrames[*link].hashNext;
+	if (*link == frameIndex)
+		*link = partition->pageFrames[frameIndex].hashNext;
+}
+
+// True if the frame holds a page that can be replaced without a write-back
+static bool isCleanFrame(PageFrame *frame)
+{
+	return frame->pageNum != NO_PAGE && frame->clientCount == 0 && !frame->isPageDirty && !frame->isLoading;
+}
+
+// Counts the change of a frame in numCleanFrames, wasClean tells whether the frame was clean before the change.
+// Fix counts, dirty flags and loading flags are only changed with the partition latch held.
+static void updateCleanCount(PoolPartition *partition, PageFrame *frame, bool wasClean)
+{
+	partition->numCleanFrames += (int)isCleanFrame(frame) - (int)wasClean;
+}
+
+// One more client uses the frame. Called with the partition latch held.
+static void pinFrame(PoolPartition *partition, int frameIndex)
+{
+	PageFrame *frame = &partition->pageFrames[frameIndex];
+	bool wasClean = isCleanFrame(frame);
+	__atomic_add_fetch(&frame->clientCount, 1, __ATOMIC_ACQ_REL);
+	updateCleanCount(partition, frame, wasClean);
+}
+
+// One client less uses the frame, the replacement policy may evict it again once no client uses it anymore.
+// Called with the partition latch held.
+static void unpinFrame(BufferPoolInfo *poolInfo, PoolPartition *partition, int frameIndex)
+{
+	PageFrame *frame = &partition->pageFrames[frameIndex];
+	if (__atomic_sub_fetch(&frame->clientCount, 1, __ATOMIC_ACQ_REL) == 0)
+	{
+		updateCleanCount(partition, frame, false);
+		if (poolInfo->policy->onUnpin != NULL)
+			poolInfo->policy->onUnpin(partition->policyData, frameIndex);
+	}
+}
+
+// Sets the dirty flag of a frame. Called with the partition latch held.
+static void setFrameDirty(PoolPartition *partition, int frameIndex, bool isDirty)
+{
+	PageFrame *frame = &partition->pageFrames[frameIndex];
+	bool wasClean = isCleanFrame(frame);
+	frame->isPageDirty = isDirty;
+	updateCleanCount(partition, frame, wasClean);
+}
+
+// Adds the frame to the write-back table under the page evicted from it
+static void insertWriteBack(PoolPartition *partition, int frameIndex)
+{
+	int bucket = hashPageNumber(partition->pageFrames[frameIndex].writeBackPageNum, partition->pageTableMask);
+	partition->pageFrames[frameIndex].writeBackNext = partition->writeBackTable[bucket];
+	partition->writeBackTable[bucket] = frameIndex;
+}
+
+// Removes the frame from the write-back table, called once the write-back of its evicted page finished
+static void removeWriteBack(PoolPartition *partition, int frameIndex)
+{
+	int *link = &partition->writeBackTable[hashPageNumber(partition->pageFrames[frameIndex].writeBackPageNum, partition->pageTableMask)];
+	while (*link != -1 && *link != frameIndex)
+		link = &partition->pageFrames[*link].writeBackNext;
+	if (*link == frameIndex)
+		*link = partition->pageFrames[frameIndex].writeBackNext;
+}
+
+// Rebuilds the page table, the write-back table, the stack of free frames and the count of clean frames of a partition
+// from its frames: frames without a page are free and used in the order of their index, the others are found under their
+// page. The page table has at least twice as many buckets as there are frames, so that chains stay short.
+static void indexFrames(PoolPartition *partition)
+{
+	free(partition->pageTable);
+	free(partition->writeBackTable);
+	free(partition->freeFrames);
+
+	int bucketCount = 1;
+	while (bucketCount < 2 * partition->numFrames)
+		bucketCount *= 2;
+	partition->pageTable = malloc(sizeof(int) * bucketCount);
+	partition->writeBackTable = malloc(sizeof(int) * bucketCount);
+	partition->pageTableMask = bucketCount - 1;
+	int iter;
+	for (iter = 0; iter < bucketCount; iter++)
+		partition->pageTable[iter] = partition->writeBackTable[iter] = -1;
+
+	partition->freeFrames = malloc(sizeof(int) * partition->numFrames);
+	partition->numFreeFrames = 0;
+	partition->numCleanFrames = 0;
+	for (iter = partition->numFrames - 1; iter >= 0; iter--)
+	{
+		if (isCleanFrame(&partition->pageFrames[iter]))
+			partition->numCleanFrames++;
+		if (partition->pageFrames[iter].pageNum == NO_PAGE)
+			partition->freeFrames[partition->numFreeFrames++] = iter;
+		else
+			insertFrame(partition, iter);
+		if (partition->pageFrames[iter].writeBackPageNum != NO_PAGE)
+			insertWriteBack(partition, iter);
+	}
+}
+
+// Microseconds since an arbitrary point in time, for measuring how long something took
+static long getMicros(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long)now.tv_sec * 1000000L + now.tv_nsec / 1000;
+}
+
+// Adds amount to a counter of a partition. The counters are relaxed atomics: they are only added up, no other
+// memory is ordered by them, and getPoolStats reads them while clients keep counting.
+static void addCount(long *counter, long amount)
+{
+	__atomic_add_fetch(counter, amount, __ATOMIC_RELAXED);
+}
+
+// Counts a transfer that started at startMicros (see getMicros) and just finished in a latency histogram of BM_PoolStats
+static void recordLatency(long *histogram, long startMicros)
+{
+	long micros = getMicros() - startMicros;
+	int bucket = 0;
+	while (bucket < BM_LATENCY_BUCKETS - 1 && micros >= (1L << bucket))
+		bucket++;
+	addCount(&histogram[bucket], 1);
+}
+
+// Counts a pin of a page that was in the pool, called with the partition latch held
+static void countHit(PoolPartition *partition, PageFrame *frame)
+{
+	addCount(&partition->stats.hits, 1);
+	if (frame->isPrefetched)
+	{
+		addCount(&partition->stats.prefetchHits, 1);
+		frame->isPrefetched = false;
+	}
+}
+
+// Counts the time a pin spent waiting for another client's transfer of its page, waitStartMicros is -1 if it did not
+// wait. Called with the partition latch held
+static void countPinWait(PoolPartition *partition, long waitStartMicros)
+{
+	if (waitStartMicros == -1)
+		return;
+	addCount(&partition->stats.pinWaits, 1);
+	addCount(&partition->stats.pinWaitMicros, getMicros() - waitStartMicros);
+}
+
+// Returns the file handle to transfer pages startPage .. startPage+count-1 with. Called with the file latch held. If the
+// pages lie inside a plain page file, the storage manager only does positional I/O on them: the latch is released and
+// a private copy of the pool's handle is returned, so that the transfer runs concurrently with all others. Otherwise
+// the pool's handle is returned and the latch stays held until releaseFileHandle.
+static SM_FileHandle *takeFileHandle(BufferPoolInfo *poolInfo, const PageNumber startPage, int count, SM_FileHandle *privateHandle)
+{
+	int fd;
+	long long offset;
+	if (startPage < 0 || getBlockLocation(startPage + count - 1, &poolInfo->fileHandle, &fd, &offset) != RC_OK)
+		return &poolInfo->fileHandle;
+
+	*privateHandle = poolInfo->fileHandle;
+	pthread_mutex_unlock(&poolInfo->fileLatch);
+	return privateHandle;
+}
+
+// Ends a transfer with a file handle returned by takeFileHandle
+static void releaseFileHandle(BufferPoolInfo *poolInfo, SM_FileHandle *fileHandle)
+{
+	if (fileHandle == &poolInfo->fileHandle)
+		pthread_mutex_unlock(&poolInfo->fileLatch);
+}
+
+// Starts bringing page pageNum into memory, *data is only filled once waitPageIO returned.
+// Zero-copy pools hand out the address of the page inside the mapping, all other pools read into the buffer *data points to.
+static RC startPageRead(BM_BufferPool *const bm, const PageNumber pageNum, SM_PageHandle *data, SM_AsyncRequest *request)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	RC result;
+
+	request->done = 1;
+	request->result = RC_OK;
+
+	pthread_mutex_lock(&poolInfo->fileLatch);
+	if (poolInfo->zeroCopy)
+	{
+		result = getBlockAddress(pageNum, &poolInfo->fileHandle, data);
+		pthread_mutex_unlock(&poolInfo->fileLatch);
+		return result;
+	}
+
+	// Pages behind the end of the file are created as empty pages
+	result = ensureCapacity(pageNum + 1, &poolInfo->fileHandle);
+	if (result != RC_OK)
+	{
+		pthread_mutex_unlock(&poolInfo->fileLatch);
+		return result;
+	}
+
+	SM_FileHandle privateHandle;
+	SM_FileHandle *fileHandle = takeFileHandle(poolInfo, pageNum, 1, &privateHandle);
+	if (poolInfo->asyncContext == NULL)
+		result = readBlock(pageNum, fileHandle, *data);
+	else
+	{
+		request->op = SM_ASYNC_READ;
+		request->pageNum = pageNum;
+		request->memPage = *data;
+		result = submitAsyncIO(poolInfo->asyncContext, fileHandle, request, 1);
+	}
+	releaseFileHandle(poolInfo, fileHandle);
+	return result;
+}
+
+// Starts writing data to page pageNum of the page file, the buffer has to stay unchanged until waitPageIO returned
+static RC startPageWrite(BM_BufferPool *const bm, const PageNumber pageNum, SM_PageHandle data, SM_AsyncRequest *request)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	RC result;
+
+	request->done = 1;
+	request->result = RC_OK;
+
+	SM_FileHandle privateHandle;
+	pthread_mutex_lock(&poolInfo->fileLatch);
+	SM_FileHandle *fileHandle = takeFileHandle(poolInfo, pageNum, 1, &privateHandle);
+	if (poolInfo->asyncContext == NULL)
+		result = writeBlock(pageNum, fileHandle, data);
+	else
+	{
+		request->op = SM_ASYNC_WRITE;
+		request->pageNum = pageNum;
+		request->memPage = data;
+		result = submitAsyncIO(poolInfo->asyncContext, fileHandle, request, 1);
+	}
+	releaseFileHandle(poolInfo, fileHandle);
+	return result;
+}
+
+// Waits for a transfer started by startPageRead or startPageWrite
+static RC waitPageIO(BM_BufferPool *const bm, SM_AsyncRequest *request)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	return (poolInfo->asyncContext == NULL) ? request->result : waitAsyncIO(poolInfo->asyncContext, request);
+}
+
+// Brings page pageNum into memory and returns its location in *data
+static RC readPageFromDisk(BM_BufferPool *const bm, const PageNumber pageNum, SM_PageHandle *data)
+{
+	SM_AsyncRequest request;
+	RC result = startPageRead(bm, pageNum, data, &request);
+	if (result == RC_OK)
+		result = waitPageIO(bm, &request);
+	return result;
+}
+
+// writeBlockToDisk writes page pageNum of a partition from its buffer data to the page file and waits until it got there
+extern RC writeBlockToDisk(BM_BufferPool *const bm, PoolPartition *partition, const PageNumber pageNum, SM_PageHandle data)
+{
+	SM_AsyncRequest request;
+	long startMicros = getMicros();
+
 	// Writing pageFrame data to the page file on disk
-	writeBlock(pageFrame[pageFrameIndex].pageNum, &fh, pageFrame[pageFrameIndex].data);
+	RC result = startPageWrite(bm, pageNum, data, &request);
+	if (result == RC_OK)
+		result = waitPageIO(bm, &request);
+	recordLatency(partition->stats.writeLatency, startMicros);
 
 	// Increase the totalDiskWriteCount which records the number of writes done by the buffer manager.
-	totalDiskWriteCount++;
+	pthread_mutex_lock(&partition->partitionLatch);
+	addCount(&partition->totalDiskWriteCount, 1);
+	pthread_mutex_unlock(&partition->partitionLatch);
+	return result;
+}
+
+// True if page pageNum was evicted and its write-back has not reached the page file yet, reading it now would give old contents
+static bool isWriteBackInFlight(PoolPartition *partition, const PageNumber pageNum)
+{
+	if (partition->numWriteBacks == 0)
+		return false;
+
+	int frameIndex = partition->writeBackTable[hashPageNumber(pageNum, partition->pageTableMask)];
+	while (frameIndex != -1 && partition->pageFrames[frameIndex].writeBackPageNum != pageNum)
+		frameIndex = partition->pageFrames[frameIndex].writeBackNext;
+	return frameIndex != -1;
 }
 
-// setNewPageToPageFrame method implemented
-extern void setNewPageToPageFrame(PageFrame *pageFrame, PageFrame *page, int pageFrameIndex)
+// Wakes the background writer up, so that it checks the partitions before its interval passed
+static void wakeBackgroundWriter(BufferPoolInfo *poolInfo)
 {
-	// Setting page frame's content to new page's content
-	pageFrame[pageFrameIndex].data = page->data;
-	pageFrame[pageFrameIndex].pageNum = page->pageNum;
-	pageFrame[pageFrameIndex].isPageDirty = page->isPageDirty;
-	pageFrame[pageFrameIndex].clientCount = page->clientCount;
-	pageFrame[pageFrameIndex].hitNumber = page->hitNumber;
+	if (!poolInfo->isWriterRunning)
+		return;
+	pthread_mutex_lock(&poolInfo->writerLatch);
+	poolInfo->writerWakeupPending = true;
+	pthread_cond_signal(&poolInfo->writerWakeup);
+	pthread_mutex_unlock(&poolInfo->writerLatch);
+}
+
+// Orders dirty pages by page number, used by qsort in writeDirtyFrames
+static int comparePageNumbers(const void *first, const void *second)
+{
+	int firstPage = ((const DirtyPage *)first)->pageNum;
+	int secondPage = ((const DirtyPage *)second)->pageNum;
+	return (firstPage > secondPage) - (firstPage < secondPage);
+}
+
+// Writes the dirtyPages back to disk and releases their frames again. The frames were pinned, latched shared and
+// marked clean by collectDirtyFrames. A page that could not be written stays dirty.
+static RC writeDirtyFrames(BM_BufferPool *const bm, DirtyPage *dirtyPages, int numDirty)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	SM_PageHandle *runData = malloc(sizeof(SM_PageHandle) * numDirty);
+	SM_AsyncRequest *writeRequests = malloc(sizeof(SM_AsyncRequest) * numDirty);
+	RC *frameResults = malloc(sizeof(RC) * numDirty);
+	int *requestFrames = malloc(sizeof(int) * numDirty);
+	int numWrites = 0;
+	RC result = RC_OK;
+
+	// Sorting them by page number, so that runs of adjacent pages can be written with one call
+	qsort(dirtyPages, numDirty, sizeof(DirtyPage), comparePageNumbers);
+
+	int iter = 0;
+	while (iter < numDirty)
+	{
+		// Finding the end of the run of adjacent pages starting at iter
+		int runLength = 1;
+		while (iter + runLength < numDirty && dirtyPages[iter + runLength].pageNum == dirtyPages[iter].pageNum + runLength)
+			runLength++;
+
+		int index;
+		if (runLength > 1)
+		{
+			// Writing the whole run with a single vectored write
+			for (index = 0; index < runLength; index++)
+				runData[index] = dirtyPages[iter + index].data;
+			long startMicros = getMicros();
+			SM_FileHandle privateHandle;
+			pthread_mutex_lock(&poolInfo->fileLatch);
+			SM_FileHandle *fileHandle = takeFileHandle(poolInfo, dirtyPages[iter].pageNum, runLength, &privateHandle);
+			RC writeResult = writeBlocks(dirtyPages[iter].pageNum, runLength, fileHandle, runData);
+			releaseFileHandle(poolInfo, fileHandle);
+			for (index = 0; index < runLength; index++)
+			{
+				frameResults[iter + index] = writeResult;
+				recordLatency(dirtyPages[iter + index].partition->stats.writeLatency, startMicros);
+			}
+		}
+		else if (poolInfo->asyncContext == NULL)
+		{
+			// Writing pageFrame data to the page file on disk
+			SM_AsyncRequest request;
+			long startMicros = getMicros();
+			frameResults[iter] = startPageWrite(bm, dirtyPages[iter].pageNum, dirtyPages[iter].data, &request);
+			recordLatency(dirtyPages[iter].partition->stats.writeLatency, startMicros);
+		}
+		else
+		{
+			// Collecting single pages so that they are written as one batch
+			writeRequests[numWrites].op = SM_ASYNC_WRITE;
+			writeRequests[numWrites].pageNum = dirtyPages[iter].pageNum;
+			writeRequests[numWrites].memPage = dirtyPages[iter].data;
+			requestFrames[numWrites] = iter;
+			numWrites++;
+		}
+		iter += runLength;
+	}
+
+	// Submitting the batch and waiting until every page reached the page file
+	if (numWrites > 0)
+	{
+		// The pages are sorted, so they all lie between the first and the last one
+		long startMicros = getMicros();
+		SM_FileHandle privateHandle;
+		PageNumber firstPage = writeRequests[0].pageNum;
+		pthread_mutex_lock(&poolInfo->fileLatch);
+		SM_FileHandle *fileHandle = takeFileHandle(poolInfo, firstPage, writeRequests[numWrites - 1].pageNum - firstPage + 1, &privateHandle);
+		// Every request is waited for, also if submitAsyncIO failed: it may have handed some of them over
+		submitAsyncIO(poolInfo->asyncContext, fileHandle, writeRequests, numWrites);
+		releaseFileHandle(poolInfo, fileHandle);
+		for (iter = 0; iter < numWrites; iter++)
+		{
+			frameResults[requestFrames[iter]] = waitAsyncIO(poolInfo->asyncContext, &writeRequests[iter]);
+			recordLatency(dirtyPages[requestFrames[iter]].partition->stats.writeLatency, startMicros);
+		}
+	}
+
+	// Releasing the pages again. A page that could not be written stays dirty, every page still counts as one write I/O.
+	// The pinned pages kept their frames, which may have moved in a resize meanwhile.
+	for (iter = 0; iter < numDirty; iter++)
+	{
+		PoolPartition *partition = dirtyPages[iter].partition;
+		pthread_mutex_lock(&partition->partitionLatch);
+		int frameIndex = findFrame(partition, dirtyPages[iter].pageNum);
+		PageFrame *frame = &partition->pageFrames[frameIndex];
+		if (frameResults[iter] != RC_OK)
+		{
+			setFrameDirty(partition, frameIndex, true);
+			if (result == RC_OK)
+				result = frameResults[iter];
+		}
+		addCount(&partition->totalDiskWriteCount, 1);
+		addCount(&partition->stats.flushedPages, 1);
+		pthread_rwlock_unlock(frame->latch);
+		unpinFrame(poolInfo, partition, frameIndex);
+		pthread_mutex_unlock(&partition->partitionLatch);
+	}
+
+	free(requestFrames);
+	free(frameResults);
+	free(writeRequests);
+	free(runData);
+	return result;
 }
 
-// Unused Function
-// creates an instance of a new page
-extern PageFrame getNewPageInstance (BM_BufferPool *const bm, const PageNumber pageNum) {
-	// Create a new page to store data read from the file.
-	PageFrame *newPage = (PageFrame *)malloc(sizeof(PageFrame));
+// Takes the dirty pages of a partition that are currently not being used for writeDirtyFrames. They are pinned while
+// they are written, so that they are not evicted, and latched shared, so that nobody modifies them meanwhile. A page
+// that a client latched exclusively after pinning it again stays dirty and is written by the next flush.
+// *dirtyPages holds *capacity pages and is grown as needed. Called with the partition latch held, returns the new
+// number of pages in *dirtyPages.
+static int collectDirtyFrames(PoolPartition *partition, DirtyPage **dirtyPages, int *capacity, int numDirty)
+{
+	PageFrame *pageFrame = partition->pageFrames;
+	if (numDirty + partition->numFrames > *capacity)
+	{
+		*capacity = numDirty + partition->numFrames;
+		*dirtyPages = realloc(*dirtyPages, sizeof(DirtyPage) * *capacity);
+	}
 
-	// Reading page from disk and initializing page frame's content in the buffer pool
-	SM_FileHandle fh;
-	openPageFile(bm->pageFile, &fh);
-	newPage->data = (SM_PageHandle)malloc(PAGE_SIZE);
-	ensureCapacity(pageNum, &fh);
-	readBlock(pageNum, &fh, newPage->data);
-	newPage->pageNum = pageNum;
-	newPage->isPageDirty = false;
-	newPage->clientCount = 1;
-	newPage->refNumber = 0;
-	newPage->hitNumber = hit;
-	return *newPage;
+	int iter;
+	for (iter = 0; iter < partition->numFrames; iter++)
+	{
+		if (pageFrame[iter].clientCount == 0 && pageFrame[iter].isPageDirty == true &&
+			pthread_rwlock_tryrdlock(pageFrame[iter].latch) == 0)
+		{
+			pinFrame(partition, iter);
+			setFrameDirty(partition, iter, false);
+			(*dirtyPages)[numDirty].partition = partition;
+			(*dirtyPages)[numDirty].pageNum = pageFrame[iter].pageNum;
+			(*dirtyPages)[numDirty].data = pageFrame[iter].data;
+			numDirty++;
+		}
+	}
+	return numDirty;
 }
 
 #pragma endregion
 
-// ***** REPLACEMENT STRATEGY FUNCTIONS ***** //
-#pragma region REPLACEMENT STRATEGY FUNCTIONS
+// ***** REPLACEMENT POLICY FUNCTIONS ***** //
+#pragma region REPLACEMENT POLICY FUNCTIONS
+
+// The replacement policy of a partition gets the partition's policyView as bm, frameIndex is local to the partition
+extern int getFrameFixCount(BM_BufferPool *const bm, int frameIndex)
+{
+	return __atomic_load_n(&((PoolPartition *)bm->mgmtData)->pageFrames[frameIndex].clientCount, __ATOMIC_ACQUIRE);
+}
+
+// Tells the replacement policy that page pageNum leaves a frame. isPicked tells whether pickVictim chose the frame,
+// other frames go to onRemove if the policy has it. Called with the partition latch held.
+static void notifyEvict(BufferPoolInfo *poolInfo, PoolPartition *partition, int frameIndex, PageNumber pageNum, bool isPicked)
+{
+	if (!isPicked && poolInfo->policy->onRemove != NULL)
+		poolInfo->policy->onRemove(partition->policyData, frameIndex, pageNum);
+	else if (poolInfo->policy->onEvict != NULL)
+		poolInfo->policy->onEvict(partition->policyData, frameIndex, pageNum);
+}
+
+// Evicts the page of an unpinned frame, isPicked tells whether pickVictim chose it. A dirty page is returned in
+// *evictedPageNum and has to be written back by the caller. Called with the partition latch held.
+static void evictFrame(BM_BufferPool *const bm, PoolPartition *partition, int victimIndex, PageNumber *evictedPageNum, bool isPicked)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PageFrame *pageFrame = partition->pageFrames;
+
+	notifyEvict(poolInfo, partition, victimIndex, pageFrame[victimIndex].pageNum, isPicked);
+	addCount(&partition->stats.evictions, 1);
+
+	// If page in memory has been modified then the page is written to the disk, clients asking for it wait until it got there
+	if (pageFrame[victimIndex].isPageDirty == true)
+	{
+		addCount(&partition->stats.dirtyWriteBacks, 1);
+		*evictedPageNum = pageFrame[victimIndex].pageNum;
+		pageFrame[victimIndex].writeBackPageNum = *evictedPageNum;
+		insertWriteBack(partition, victimIndex);
+		partition->numWriteBacks++;
+	}
+
+	// The page table does not find the frame under the evicted page anymore
+	removeFrame(partition, victimIndex);
+}
+
+// Returns the frame that gets page pageNum: a frame without a page or else the frame the replacement policy chooses,
+// -1 if every frame is pinned. A dirty victim page is returned in *evictedPageNum (NO_PAGE otherwise) and has to be
+// written back by the caller. Called with the partition latch held.
+static int takeFrame(BM_BufferPool *const bm, PoolPartition *partition, const PageNumber pageNum, PageNumber *evictedPageNum)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	*evictedPageNum = NO_PAGE;
+
+	if (partition->numFreeFrames > 0)
+		return partition->freeFrames[--partition->numFreeFrames];
+
+	// A policy that does not check the fix count may return a frame pinned without a hit (by forcePage), that is no victim either
+	int victimIndex = poolInfo->policy->pickVictim(partition->policyData, &partition->policyView, pageNum);
+	if (victimIndex == -1 || getFrameFixCount(&partition->policyView, victimIndex) != 0)
+		return -1;
+
+	evictFrame(bm, partition, victimIndex, evictedPageNum, true);
+	return victimIndex;
+}
+
+// Returns the frame of the access strategy's ring that gets page pageNum, -1 if the ring has no frame to recycle yet.
+// Only frames of the page's partition that still hold the page the ring loaded and are not used by anybody are
+// recycled, the oldest first. Their pages are evicted without asking the replacement policy, so that the operation
+// does not push the pages of other clients out of the pool. Called with the partition latch held.
+static int takeRingFrame(BM_BufferPool *const bm, PoolPartition *partition, BM_AccessStrategy *const access, PageNumber *evictedPageNum)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	*evictedPageNum = NO_PAGE;
+
+	// The ring is filled with frames taken the usual way first
+	if (access->ringFrames[access->nextSlot] == -1)
+		return -1;
+
+	int iter;
+	for (iter = 0; iter < access->ringSize; iter++)
+	{
+		int slot = (access->nextSlot + iter) % access->ringSize;
+		// Ring frames are indexed within the partition of the page they were loaded with
+		int frameIndex = access->ringFrames[slot];
+		if (frameIndex < 0 || frameIndex >= partition->numFrames || getPartition(poolInfo, access->ringPages[slot]) != partition)
+			continue;
+
+		PageFrame *frame = &partition->pageFrames[frameIndex];
+		if (frame->pageNum == access->ringPages[slot] && frame->clientCount == 0 && !frame->isLoading && frame->writeBackPageNum == NO_PAGE)
+		{
+			access->nextSlot = slot;
+			evictFrame(bm, partition, frameIndex, evictedPageNum, false);
+			return frameIndex;
+		}
+	}
+	return -1;
+}
+
+// Gives page pageNum a frame of its partition: the frame is found under the page from now on and stays pinned and
+// loading until finishFrameLoad. Returns -1 if every frame is pinned. A dirty victim page is returned in *evictedPageNum
+// and has to be written back before the frame's buffer is overwritten. With an access strategy (may be NULL) the frame
+// is recycled from its ring if possible and becomes part of the ring. Called with the partition latch held.
+static int reserveFrame(BM_BufferPool *const bm, PoolPartition *partition, const PageNumber pageNum, PageNumber *evictedPageNum,
+						BM_AccessStrategy *const access)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PageFrame *pageFrame = partition->pageFrames;
+
+	// A strategy whose ring was freed is ignored
+	BM_AccessStrategy *ring = (access != NULL && access->ringSize > 0) ? access : NULL;
+	int frameIndex = (ring != NULL) ? takeRingFrame(bm, partition, ring, evictedPageNum) : -1;
+	if (frameIndex == -1)
+		frameIndex = takeFrame(bm, partition, pageNum, evictedPageNum);
+	if (frameIndex == -1)
+		return -1;
+
+	// The frame takes the oldest slot of the ring
+	if (ring != NULL)
+	{
+		ring->ringFrames[ring->nextSlot] = frameIndex;
+		ring->ringPages[ring->nextSlot] = pageNum;
+		ring->nextSlot = (ring->nextSlot + 1) % ring->ringSize;
+	}
+
+	// The frame still shows the clean page it may have been evicted with
+	bool wasClean = isCleanFrame(&pageFrame[frameIndex]);
+	pageFrame[frameIndex].pageNum = pageNum;
+	pageFrame[frameIndex].isPageDirty = false;
+	pageFrame[frameIndex].isLoading = true;
+	pageFrame[frameIndex].lastAccess = ++partition->accessClock;
+	pageFrame[frameIndex].isPrefetched = false;
+	__atomic_store_n(&pageFrame[frameIndex].clientCount, 1, __ATOMIC_RELEASE);
+	updateCleanCount(partition, &pageFrame[frameIndex], wasClean);
+	insertFrame(partition, frameIndex);
+	poolInfo->policy->onLoad(partition->policyData, frameIndex, pageNum);
+	return frameIndex;
+}
+
+// Finishes loading the frame reserved by reserveFrame for page pageNum once the page was read into readBuffer (result
+// tells whether that worked) and the evicted page was written back from evictedData (writeResult tells whether that
+// worked). If the write-back failed, the frame keeps the evicted page as a dirty page and the new page is not loaded.
+// The frame stays pinned if keepPinned is set.
+static void finishFrameLoad(BM_BufferPool *const bm, PoolPartition *partition, const PageNumber pageNum, SM_PageHandle readBuffer,
+							SM_PageHandle evictedData, const PageNumber evictedPageNum, RC writeResult, RC result, bool keepPinned)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+
+	// The loading frame stays in the page table under its page, a resize may have moved it meanwhile
+	pthread_mutex_lock(&partition->partitionLatch);
+	PageFrame *pageFrame = partition->pageFrames;
+	int frameIndex = findFrame(partition, pageNum);
+	if (evictedPageNum != NO_PAGE)
+	{
+		// Increase the totalDiskWriteCount which records the number of writes done by the buffer manager.
+		removeWriteBack(partition, frameIndex);
+		pageFrame[frameIndex].writeBackPageNum = NO_PAGE;
+		partition->numWriteBacks--;
+		if (writeResult == RC_OK)
+			addCount(&partition->totalDiskWriteCount, 1);
+	}
+
+	// The evicted page would be lost: it goes back into the frame, still dirty, and the buffer read into is the spare buffer again
+	if (evictedPageNum != NO_PAGE && writeResult != RC_OK)
+	{
+		if (readBuffer != evictedData && !poolInfo->zeroCopy)
+			partition->spareData = readBuffer;
+		removeFrame(partition, frameIndex);
+		notifyEvict(poolInfo, partition, frameIndex, pageNum, false);
+		pageFrame[frameIndex].pageNum = evictedPageNum;
+		pageFrame[frameIndex].data = evictedData;
+		pageFrame[frameIndex].isLoading = false;
+		insertFrame(partition, frameIndex);
+		poolInfo->policy->onLoad(partition->policyData, frameIndex, evictedPageNum);
+		setFrameDirty(partition, frameIndex, true);
+		unpinFrame(poolInfo, partition, frameIndex);
+		pthread_cond_broadcast(&partition->frameLoaded);
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return;
+	}
+
+	// The evicted frame's buffer becomes the new spare buffer
+	if (readBuffer != evictedData && !poolInfo->zeroCopy)
+		partition->spareData = evictedData;
+	pageFrame[frameIndex].data = readBuffer;
+	pageFrame[frameIndex].isLoading = false;
+
+	// Only pages that were read count as reads, the pages read by a prefetch in their own counter
+	if (result == RC_OK)
+		addCount(pageFrame[frameIndex].isPrefetched ? &partition->stats.prefetchedPages : &partition->numPagesReadCount, 1);
+
+	// A frame whose page could not be loaded holds no page anymore
+	if (result != RC_OK)
+	{
+		removeFrame(partition, frameIndex);
+		notifyEvict(poolInfo, partition, frameIndex, pageFrame[frameIndex].pageNum, false);
+		pageFrame[frameIndex].pageNum = NO_PAGE;
+		__atomic_store_n(&pageFrame[frameIndex].clientCount, 0, __ATOMIC_RELEASE);
+		partition->freeFrames[partition->numFreeFrames++] = frameIndex;
+	}
+	else if (!keepPinned)
+		unpinFrame(poolInfo, partition, frameIndex);
+	pthread_cond_broadcast(&partition->frameLoaded);
+	pthread_mutex_unlock(&partition->partitionLatch);
+}
+
+// Reads page pageNum into a frame of its partition and pins it. Called with the partition latch held, the latch is
+// released while the page is read and the evicted page is written back, so that other clients are not held up by the I/O.
+static RC loadPage(BM_BufferPool *const bm, PoolPartition *partition, BM_PageHandle *const page, const PageNumber pageNum,
+				   BM_AccessStrategy *const access)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PageNumber evictedPageNum;
+
+	int frameIndex = reserveFrame(bm, partition, pageNum, &evictedPageNum, access);
+	if (frameIndex == -1)
+	{
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return RC_PINNED_PAGES_IN_BUFFER;
+	}
+	addCount(&partition->stats.misses, 1);
+
+	// While the evicted page is written back, the new page is read into the spare buffer if it is not used by another client
+	SM_PageHandle evictedData = partition->pageFrames[frameIndex].data;
+	SM_PageHandle readBuffer = evictedData;
+	if (evictedPageNum != NO_PAGE && partition->spareData != NULL)
+	{
+		readBuffer = partition->spareData;
+		partition->spareData = NULL;
+	}
+	pthread_mutex_unlock(&partition->partitionLatch);
 
-// First In First Out Implementation
-extern void FIFO(BM_BufferPool *const bm, PageFrame *page)
+	// The write-back is started first. Without the spare buffer the read has to wait for it, as it overwrites the same buffer.
+	SM_AsyncRequest writeRequest, readRequest;
+	RC writeResult = RC_OK;
+	long writeStartMicros = getMicros();
+	if (evictedPageNum != NO_PAGE)
+	{
+		writeResult = startPageWrite(bm, evictedPageNum, evictedData, &writeRequest);
+		if (writeResult == RC_OK && readBuffer == evictedData)
+			writeResult = waitPageIO(bm, &writeRequest);
+	}
+	// The buffer of the evicted page is not overwritten if its write-back failed
+	RC result = writeResult;
+	if (result == RC_OK)
+	{
+		long readStartMicros = getMicros();
+		result = startPageRead(bm, pageNum, &readBuffer, &readRequest);
+		if (result == RC_OK)
+			result = waitPageIO(bm, &readRequest);
+		recordLatency(partition->stats.readLatency, readStartMicros);
+	}
+	if (evictedPageNum != NO_PAGE && writeResult == RC_OK && readBuffer != evictedData)
+		writeResult = waitPageIO(bm, &writeRequest);
+	if (evictedPageNum != NO_PAGE)
+		recordLatency(partition->stats.writeLatency, writeStartMicros);
+
+	finishFrameLoad(bm, partition, pageNum, readBuffer, evictedData, evictedPageNum, writeResult, result, true);
+	if (result == RC_OK)
+		result = writeResult;
+
+	// The client paid for the write-back of a dirty victim, the background writer is falling behind
+	if (evictedPageNum != NO_PAGE)
+		wakeBackgroundWriter(poolInfo);
+
+	if (result != RC_OK)
+		return result;
+	page->pageNum = pageNum;
+	page->data = readBuffer;
+	return RC_OK;
+}
+
+// Reads the runs of adjacent pages among the loads with one readBlocks call each, through a
+// buffer that is copied into the frames. The pages are in the file. Returns false if there is no memory for the buffer.
+static bool readSequentialRuns(BM_BufferPool *const bm, FrameLoad *loads, int numLoads)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	SM_PageHandle runBuffer = NULL;
+	if (posix_memalign((void **)&runBuffer, SM_DIRECT_IO_ALIGNMENT, (size_t)numLoads * bm->pageSize) != 0)
+		return false;
 
 	int iter = 0;
-	int currentIndex = numPagesReadCount % bufferSize;
+	while (iter < numLoads)
+	{
+		// Finding the end of the run of adjacent pages starting at iter, loads whose victim could not be written are skipped
+		int runLength = 0;
+		while (iter + runLength < numLoads && loads[iter + runLength].result == RC_OK &&
+			   loads[iter + runLength].pageNum == loads[iter].pageNum + runLength)
+			runLength++;
+		if (runLength == 0)
+		{
+			iter++;
+			continue;
+		}
+
+		long startMicros = getMicros();
+		SM_FileHandle privateHandle;
+		pthread_mutex_lock(&poolInfo->fileLatch);
+		SM_FileHandle *fileHandle = takeFileHandle(poolInfo, loads[iter].pageNum, runLength, &privateHandle);
+		RC result = readBlocks(loads[iter].pageNum, runLength, fileHandle, runBuffer);
+		releaseFileHandle(poolInfo, fileHandle);
 
-	// Interating through all the page frames in the buffer pool
-	for (iter = 0; iter < bufferSize; iter++)
+		int index;
+		for (index = iter; index < iter + runLength; index++)
+		{
+			recordLatency(loads[index].partition->stats.readLatency, startMicros);
+			loads[index].result = result;
+			if (result == RC_OK)
+				memcpy(loads[index].data, runBuffer + (size_t)(index - iter) * bm->pageSize, bm->pageSize);
+		}
+		iter += runLength;
+	}
+	free(runBuffer);
+	return true;
+}
+
+// Reads the pages of frames reserved by reserveFrame, all transfers are started before the first one is waited for.
+// The evicted dirty pages are written back first, as the pages are read into the same buffers. With an asynchronous
+// engine all reads are submitted as one batch. With sequential set, loads holds pages of the file in ascending order
+// and runs of adjacent pages are read with one call each. The frames stay pinned if keepPinned is set.
+static void loadReservedFrames(BM_BufferPool *const bm, FrameLoad *loads, int numLoads, bool keepPinned, bool sequential)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	SM_AsyncRequest *requests = malloc(sizeof(SM_AsyncRequest) * numLoads);
+	int *requestLoads = malloc(sizeof(int) * numLoads);
+
+	// Writing the evicted dirty pages back
+	int iter;
+	long startMicros = getMicros();
+	for (iter = 0; iter < numLoads; iter++)
+	{
+		loads[iter].writeResult = RC_OK;
+		loads[iter].data = loads[iter].evictedData;
+		if (loads[iter].evictedPageNum != NO_PAGE)
+			loads[iter].writeResult = startPageWrite(bm, loads[iter].evictedPageNum, loads[iter].evictedData, &requests[iter]);
+	}
+	for (iter = 0; iter < numLoads; iter++)
 	{
-		// Check if the current page frame is not being used by any client
-		if (pageFrame[currentIndex].clientCount != 0)
+		if (loads[iter].evictedPageNum != NO_PAGE)
 		{
-			currentIndex++;
-			// For the last page in the buffer pool, Current Index equals bufferSize-1
-			if (currentIndex % bufferSize == 0)
+			if (loads[iter].writeResult == RC_OK)
+				loads[iter].writeResult = waitPageIO(bm, &requests[iter]);
+			recordLatency(loads[iter].partition->stats.writeLatency, startMicros);
+		}
+		// The frames whose evicted page could not be written back are not read into
+		loads[iter].result = loads[iter].writeResult;
+	}
+
+	// Sequential loads fall back to the reads of single pages if there is no memory for the run buffer
+	bool isRead = (sequential && readSequentialRuns(bm, loads, numLoads));
+	if (!isRead && poolInfo->asyncContext != NULL)
+	{
+		// Submitting all reads at once, pages behind the end of the file are created as empty pages first
+		int numRequests = 0;
+		PageNumber firstPage = 0, lastPage = 0;
+		for (iter = 0; iter < numLoads; iter++)
+		{
+			if (loads[iter].result != RC_OK)
+				continue;
+			requests[numRequests].op = SM_ASYNC_READ;
+			requests[numRequests].pageNum = loads[iter].pageNum;
+			requests[numRequests].memPage = loads[iter].data;
+			requestLoads[numRequests++] = iter;
+			if (numRequests == 1 || loads[iter].pageNum < firstPage)
+				firstPage = loads[iter].pageNum;
+			if (loads[iter].pageNum > lastPage)
+				lastPage = loads[iter].pageNum;
+		}
+		if (numRequests > 0)
+		{
+			startMicros = getMicros();
+			pthread_mutex_lock(&poolInfo->fileLatch);
+			// Every submitted request is waited for, also if submitAsyncIO failed: it may have handed some of them over
+			RC capacityResult = ensureCapacity(lastPage + 1, &poolInfo->fileHandle);
+			if (capacityResult == RC_OK)
 			{
-				// Resetting index to 0, if last page has already been read.
-				currentIndex = 0;
+				SM_FileHandle privateHandle;
+				SM_FileHandle *fileHandle = takeFileHandle(poolInfo, firstPage, lastPage - firstPage + 1, &privateHandle);
+				submitAsyncIO(poolInfo->asyncContext, fileHandle, requests, numRequests);
+				releaseFileHandle(poolInfo, fileHandle);
 			}
 			else
-				currentIndex = currentIndex;
+				pthread_mutex_unlock(&poolInfo->fileLatch);
+			for (iter = 0; iter < numRequests; iter++)
+			{
+				loads[requestLoads[iter]].result = (capacityResult != RC_OK) ? capacityResult : waitAsyncIO(poolInfo->asyncContext, &requests[iter]);
+				recordLatency(loads[requestLoads[iter]].partition->stats.readLatency, startMicros);
+			}
+		}
+	}
+	else if (!isRead)
+	{
+		// Synchronous I/O reads one page after the other
+		for (iter = 0; iter < numLoads; iter++)
+		{
+			if (loads[iter].result != RC_OK)
+				continue;
+			startMicros = getMicros();
+			loads[iter].result = readPageFromDisk(bm, loads[iter].pageNum, &loads[iter].data);
+			recordLatency(loads[iter].partition->stats.readLatency, startMicros);
+		}
+	}
+
+	for (iter = 0; iter < numLoads; iter++)
+		finishFrameLoad(bm, loads[iter].partition, loads[iter].pageNum, loads[iter].data, loads[iter].evictedData,
+						loads[iter].evictedPageNum, loads[iter].writeResult, loads[iter].result, keepPinned);
+
+	free(requestLoads);
+	free(requests);
+}
+
+#pragma endregion
+
+// ***** BACKGROUND WRITER FUNCTIONS ***** //
+#pragma region BACKGROUND WRITER FUNCTIONS
+
+// Number of frames of a partition that can be replaced without a write-back: frames without a page and clean unpinned frames.
+// Called with the partition latch held.
+static int countCleanFrames(PoolPartition *partition)
+{
+	return partition->numFreeFrames + partition->numCleanFrames;
+}
+
+// Background writer of a pool: whenever fewer than cleanFramesPercent of the frames of a partition are clean and unpinned,
+// it writes the dirty unpinned pages of that partition back, so that the next victims do not have to be written by pinPage.
+// The pages of all such partitions are written together, runs of adjacent pages with one call.
+static void *runBackgroundWriter(void *arg)
+{
+	BM_BufferPool *bm = (BM_BufferPool *)arg;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	DirtyPage *dirtyPages = NULL;
+	int capacity = 0;
+
+	pthread_mutex_lock(&poolInfo->writerLatch);
+	while (!poolInfo->stopWriter)
+	{
+		poolInfo->writerWakeupPending = false;
+		pthread_mutex_unlock(&poolInfo->writerLatch);
+
+		int numDirty = 0;
+		int iter;
+		for (iter = 0; iter < poolInfo->numPartitions; iter++)
+		{
+			PoolPartition *partition = &poolInfo->partitions[iter];
+			pthread_mutex_lock(&partition->partitionLatch);
+			if (countCleanFrames(partition) * 100 < poolInfo->cleanFramesPercent * partition->numFrames)
+				numDirty = collectDirtyFrames(partition, &dirtyPages, &capacity, numDirty);
+			pthread_mutex_unlock(&partition->partitionLatch);
+		}
+
+		// Pages that could not be written stay dirty, they are tried again or written back when they are evicted
+		if (numDirty > 0)
+			writeDirtyFrames(bm, dirtyPages, numDirty);
+
+		// Sleeping until the interval passed or a client wakes the writer up
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_nsec += WRITER_INTERVAL_MS * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		pthread_mutex_lock(&poolInfo->writerLatch);
+		while (!poolInfo->stopWriter && !poolInfo->writerWakeupPending)
+		{
+			if (pthread_cond_timedwait(&poolInfo->writerWakeup, &poolInfo->writerLatch, &deadline) != 0)
+				break;
+		}
+	}
+	pthread_mutex_unlock(&poolInfo->writerLatch);
+
+	free(dirtyPages);
+	return NULL;
+}
+
+// Starts the background writer of a pool, the pool runs without one if the thread cannot be created
+static void startBackgroundWriter(BM_BufferPool *const bm)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	poolInfo->stopWriter = false;
+	poolInfo->writerWakeupPending = false;
+	poolInfo->isWriterRunning = (pthread_create(&poolInfo->writerThread, NULL, runBackgroundWriter, bm) == 0);
+}
+
+// Stops the background writer of a pool and waits until it wrote the pages it took
+static void stopBackgroundWriter(BufferPoolInfo *poolInfo)
+{
+	if (!poolInfo->isWriterRunning)
+		return;
+	pthread_mutex_lock(&poolInfo->writerLatch);
+	poolInfo->stopWriter = true;
+	pthread_cond_signal(&poolInfo->writerWakeup);
+	pthread_mutex_unlock(&poolInfo->writerLatch);
+	pthread_join(poolInfo->writerThread, NULL);
+	poolInfo->isWriterRunning = false;
+}
+
+#pragma endregion
+
+// ***** PREFETCH FUNCTIONS ***** //
+#pragma region PREFETCH FUNCTIONS
+
+// Takes frames for the pages startPage .. startPage+count-1 that are not in the pool yet and are not behind the end of
+// the page file, with an access strategy (may be NULL) from its ring. *loads is set to the pages to read (NULL if there
+// are none), returns their number.
+static int reservePrefetchFrames(BM_BufferPool *const bm, const PageNumber startPage, int count, BM_AccessStrategy *const access,
+								 FrameLoad **loads)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	*loads = NULL;
+
+	// A prefetch never takes more than half of the pool (or of the ring), so that it does not evict the pages it prefetched before they are used
+	pthread_mutex_lock(&poolInfo->fileLatch);
+	int totalNumPages = poolInfo->fileHandle.totalNumPages;
+	pthread_mutex_unlock(&poolInfo->fileLatch);
+	if (count > totalNumPages - startPage)
+		count = totalNumPages - startPage;
+	int numPages = __atomic_load_n(&bm->numPages, __ATOMIC_RELAXED);
+	if (count > numPages / 2)
+		count = (numPages / 2 > 0) ? numPages / 2 : 1;
+	if (access != NULL && access->ringSize > 0 && count > access->ringSize / 2)
+		count = (access->ringSize / 2 > 0) ? access->ringSize / 2 : 1;
+	if (count <= 0)
+		return 0;
+
+	FrameLoad *pageLoads = malloc(sizeof(FrameLoad) * count);
+	int numLoads = 0;
+
+	// Taking the frames, pages that are in the pool or are being written back are skipped
+	int iter;
+	for (iter = 0; iter < count; iter++)
+	{
+		PageNumber pageNum = startPage + iter;
+		PoolPartition *partition = getPartition(poolInfo, pageNum);
+		pthread_mutex_lock(&partition->partitionLatch);
+		if (findFrame(partition, pageNum) != -1 || isWriteBackInFlight(partition, pageNum))
+		{
+			pthread_mutex_unlock(&partition->partitionLatch);
+			continue;
+		}
+		int frameIndex = reserveFrame(bm, partition, pageNum, &pageLoads[numLoads].evictedPageNum, access);
+		if (frameIndex != -1)
+		{
+			partition->pageFrames[frameIndex].isPrefetched = true;
+			pageLoads[numLoads].partition = partition;
+			pageLoads[numLoads].pageNum = pageNum;
+			pageLoads[numLoads].evictedData = partition->pageFrames[frameIndex].data;
+			numLoads++;
+		}
+		pthread_mutex_unlock(&partition->partitionLatch);
+	}
+
+	if (numLoads == 0)
+		free(pageLoads);
+	else
+		*loads = pageLoads;
+	return numLoads;
+}
+
+// Reads the pages startPage .. startPage+count-1 that are not in the pool yet into frames of their partitions. The frames
+// of all pages are taken first, then the pages are read together by loadReservedFrames (see sequential there). Pages
+// behind the end of the page file are not read and the pages are left unpinned.
+static void prefetchRange(BM_BufferPool *const bm, const PageNumber startPage, int count, bool sequential)
+{
+	FrameLoad *loads;
+	int numLoads = reservePrefetchFrames(bm, startPage, count, NULL, &loads);
+	if (numLoads > 0)
+		loadReservedFrames(bm, loads, numLoads, false, sequential);
+	free(loads);
+}
+
+// Orders page numbers, used by qsort in warmUpPool
+static int comparePages(const void *first, const void *second)
+{
+	PageNumber firstPage = *(const PageNumber *)first;
+	PageNumber secondPage = *(const PageNumber *)second;
+	return (firstPage > secondPage) - (firstPage < secondPage);
+}
+
+// Reads the pages of a warm start in ascending order, every run of adjacent pages with large sequential reads.
+// Stops early when the prefetcher is stopped.
+static void warmUpPool(BM_BufferPool *const bm, PageNumber *pages, int numPages)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	int maxRunLength = (bm->numPages / 2 > 0) ? bm->numPages / 2 : 1;
+	qsort(pages, numPages, sizeof(PageNumber), comparePages);
+
+	int iter = 0;
+	while (iter < numPages)
+	{
+		pthread_mutex_lock(&poolInfo->prefetchLatch);
+		bool stop = poolInfo->stopPrefetcher;
+		pthread_mutex_unlock(&poolInfo->prefetchLatch);
+		if (stop)
+			return;
+
+		// A run is as long as a prefetch may be, a page listed twice does not end it
+		int runLength = 1;
+		int next = iter + 1;
+		while (next < numPages && runLength < maxRunLength && pages[next] <= pages[iter] + runLength)
+		{
+			if (pages[next] == pages[iter] + runLength)
+				runLength++;
+			next++;
+		}
+		prefetchRange(bm, pages[iter], runLength, true);
+		iter = next;
+	}
+}
+
+// Prefetcher of a pool: reads the pages of a warm start, then the ranges of the prefetch queue one after the other
+static void *runPrefetcher(void *arg)
+{
+	BM_BufferPool *bm = (BM_BufferPool *)arg;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+
+	pthread_mutex_lock(&poolInfo->prefetchLatch);
+	while (!poolInfo->stopPrefetcher)
+	{
+		if (poolInfo->warmPages != NULL)
+		{
+			PageNumber *warmPages = poolInfo->warmPages;
+			int numWarmPages = poolInfo->numWarmPages;
+			poolInfo->warmPages = NULL;
+			poolInfo->numWarmPages = 0;
+			pthread_mutex_unlock(&poolInfo->prefetchLatch);
+
+			warmUpPool(bm, warmPages, numWarmPages);
+			free(warmPages);
+			pthread_mutex_lock(&poolInfo->prefetchLatch);
+			continue;
+		}
+
+		if (poolInfo->prefetchLength == 0)
+		{
+			pthread_cond_wait(&poolInfo->prefetchWakeup, &poolInfo->prefetchLatch);
+			continue;
+		}
+
+		PageNumber startPage = poolInfo->prefetchStart[poolInfo->prefetchHead];
+		int count = poolInfo->prefetchCount[poolInfo->prefetchHead];
+		FrameLoad *loads = poolInfo->prefetchLoads[poolInfo->prefetchHead];
+		poolInfo->prefetchHead = (poolInfo->prefetchHead + 1) % PREFETCH_QUEUE_SIZE;
+		poolInfo->prefetchLength--;
+		pthread_mutex_unlock(&poolInfo->prefetchLatch);
+
+		if (loads != NULL)
+		{
+			loadReservedFrames(bm, loads, count, false, false);
+			free(loads);
 		}
 		else
+			prefetchRange(bm, startPage, count, false);
+		pthread_mutex_lock(&poolInfo->prefetchLatch);
+	}
+	pthread_mutex_unlock(&poolInfo->prefetchLatch);
+	return NULL;
+}
+
+// Starts the prefetcher of a pool unless it is running, called with the prefetch latch held
+static void startPrefetcher(BM_BufferPool *const bm)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	if (poolInfo->isPrefetcherRunning)
+		return;
+	poolInfo->stopPrefetcher = false;
+	poolInfo->isPrefetcherRunning = (pthread_create(&poolInfo->prefetchThread, NULL, runPrefetcher, bm) == 0);
+}
+
+// Stops the prefetcher of a pool, pending requests and the rest of a warm start are dropped and the pages being read are
+// finished first. The pending requests whose frames are reserved already are read before it returns.
+static void stopPrefetcher(BM_BufferPool *const bm)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	if (!poolInfo->isPrefetcherRunning)
+		return;
+	pthread_mutex_lock(&poolInfo->prefetchLatch);
+	poolInfo->stopPrefetcher = true;
+	free(poolInfo->warmPages);
+	poolInfo->warmPages = NULL;
+	poolInfo->numWarmPages = 0;
+	pthread_cond_signal(&poolInfo->prefetchWakeup);
+	pthread_mutex_unlock(&poolInfo->prefetchLatch);
+	pthread_join(poolInfo->prefetchThread, NULL);
+	poolInfo->isPrefetcherRunning = false;
+
+	for (; poolInfo->prefetchLength > 0; poolInfo->prefetchLength--)
+	{
+		int head = poolInfo->prefetchHead;
+		poolInfo->prefetchHead = (head + 1) % PREFETCH_QUEUE_SIZE;
+		if (poolInfo->prefetchLoads[head] == NULL)
+			continue;
+		loadReservedFrames(bm, poolInfo->prefetchLoads[head], poolInfo->prefetchCount[head], false, false);
+		free(poolInfo->prefetchLoads[head]);
+	}
+}
+
+// Counts pins of adjacent pages and starts a read-ahead of the next readAheadPages pages on the third one. Further
+// read-aheads are started when the pins reached the second half of the pages read ahead. The pages are read into the
+// ring of access (may be NULL), like the pinned pages.
+static void noteSequentialPin(BM_BufferPool *const bm, const PageNumber pageNum, BM_AccessStrategy *const access)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PageNumber lastPage = __atomic_exchange_n(&poolInfo->lastPinnedPage, pageNum, __ATOMIC_RELAXED);
+
+	// Pinning the same page again neither continues nor breaks the run
+	if (pageNum == lastPage)
+		return;
+	if (lastPage == NO_PAGE || pageNum != lastPage + 1)
+	{
+		__atomic_store_n(&poolInfo->sequentialPins, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&poolInfo->readAheadEnd, 0, __ATOMIC_RELAXED);
+		return;
+	}
+	if (__atomic_add_fetch(&poolInfo->sequentialPins, 1, __ATOMIC_RELAXED) < 2)
+		return;
+
+	PageNumber readAheadEnd = __atomic_load_n(&poolInfo->readAheadEnd, __ATOMIC_RELAXED);
+	if (pageNum + poolInfo->readAheadPages / 2 < readAheadEnd)
+		return;
+	PageNumber startPage = (readAheadEnd > pageNum) ? readAheadEnd : pageNum + 1;
+	PageNumber endPage = pageNum + 1 + poolInfo->readAheadPages;
+	__atomic_store_n(&poolInfo->readAheadEnd, endPage, __ATOMIC_RELAXED);
+	prefetchPagesWithStrategy(bm, startPage, endPage - startPage, access);
+}
+
+// prefetchPages asks the pool to read pages startPage .. startPage+count-1 in the background, it does not wait for them
+extern RC prefetchPages(BM_BufferPool *const bm, const PageNumber startPage, const int count)
+{
+	return prefetchPagesWithStrategy(bm, startPage, count, NULL);
+}
+
+// prefetchPagesWithStrategy prefetches like prefetchPages, with access (may be NULL) the pages are read into frames of
+// its ring. The frames are taken right away, as the ring is only used by the thread of its operation, only the reads are
+// left to the prefetcher.
+extern RC prefetchPagesWithStrategy(BM_BufferPool *const bm, const PageNumber startPage, const int count,
+									BM_AccessStrategy *const access)
+{
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+	if (startPage < 0 || count < 0)
+		return RC_ERROR;
+
+	// Pinning a page of a zero-copy pool needs no read, there is nothing to prefetch
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	if (poolInfo->zeroCopy || count == 0)
+		return RC_OK;
+
+	FrameLoad *loads = NULL;
+	int numLoads = count;
+	if (access != NULL && access->ringSize > 0)
+	{
+		numLoads = reservePrefetchFrames(bm, startPage, count, access, &loads);
+		if (numLoads == 0)
+			return RC_OK;
+	}
+
+	pthread_mutex_lock(&poolInfo->prefetchLatch);
+	startPrefetcher(bm);
+
+	// A prefetch is only a hint, it is dropped if the queue is full or the prefetcher could not be started
+	bool isQueued = false;
+	if (poolInfo->isPrefetcherRunning && poolInfo->prefetchLength < PREFETCH_QUEUE_SIZE)
+	{
+		int tail = (poolInfo->prefetchHead + poolInfo->prefetchLength) % PREFETCH_QUEUE_SIZE;
+		poolInfo->prefetchStart[tail] = startPage;
+		poolInfo->prefetchCount[tail] = numLoads;
+		poolInfo->prefetchLoads[tail] = loads;
+		poolInfo->prefetchLength++;
+		pthread_cond_signal(&poolInfo->prefetchWakeup);
+		isQueued = true;
+	}
+	pthread_mutex_unlock(&poolInfo->prefetchLatch);
+
+	// Frames that were reserved already are read by the client itself then
+	if (!isQueued && loads != NULL)
+	{
+		loadReservedFrames(bm, loads, numLoads, false, false);
+		free(loads);
+	}
+	return RC_OK;
+}
+
+// Orders the pages of a partition by their last access, the most recent first, used by qsort in writeWarmStartFile
+static int compareLastAccess(const void *first, const void *second)
+{
+	unsigned long firstAccess = ((const PageFrame *)first)->lastAccess;
+	unsigned long secondAccess = ((const PageFrame *)second)->lastAccess;
+	return (firstAccess < secondAccess) - (firstAccess > secondAccess);
+}
+
+// Lists the pages in the pool in its warm start file, one page number per line, the most recently used first. Every
+// partition orders its pages by their last access, the partitions are interleaved by that rank. The list is written
+// under a temporary name and renamed, so that a crash never leaves half a list behind. The file is only a hint, a
+// pool that cannot write it shuts down nevertheless. Called by shutdownBufferPool once no page is pinned anymore.
+static void writeWarmStartFile(BM_BufferPool *const bm)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	char *tempFileName = malloc(strlen(poolInfo->warmStartFile) + 5);
+	sprintf(tempFileName, "%s.tmp", poolInfo->warmStartFile);
+	FILE *file = fopen(tempFileName, "w");
+	if (file == NULL)
+	{
+		free(tempFileName);
+		return;
+	}
+
+	// Copies of the frames holding a page, partition by partition, each partition sorted by last access
+	PageFrame *frames = malloc(sizeof(PageFrame) * bm->numPages);
+	int *firstFrames = malloc(sizeof(int) * (poolInfo->numPartitions + 1));
+	int numFrames = 0;
+	int maxRank = 0;
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		firstFrames[iter] = numFrames;
+		int frameIndex;
+		for (frameIndex = 0; frameIndex < partition->numFrames; frameIndex++)
 		{
-			// If page in memory has been modified then write the page to the disk
-			if (pageFrame[currentIndex].isPageDirty == true)
-			{
-				writeBlockToDisk(bm, pageFrame, currentIndex);
-			}
+			if (partition->pageFrames[frameIndex].pageNum != NO_PAGE)
+				frames[numFrames++] = partition->pageFrames[frameIndex];
+		}
+		qsort(frames + firstFrames[iter], numFrames - firstFrames[iter], sizeof(PageFrame), compareLastAccess);
+		if (numFrames - firstFrames[iter] > maxRank)
+			maxRank = numFrames - firstFrames[iter];
+	}
+	firstFrames[poolInfo->numPartitions] = numFrames;
+
+	int rank;
+	bool written = true;
+	for (rank = 0; rank < maxRank && written; rank++)
+	{
+		for (iter = 0; iter < poolInfo->numPartitions && written; iter++)
+		{
+			if (firstFrames[iter] + rank < firstFrames[iter + 1])
+				written = (fprintf(file, "%d\n", frames[firstFrames[iter] + rank].pageNum) > 0);
+		}
+	}
+
+	if (fclose(file) == 0 && written)
+		rename(tempFileName, poolInfo->warmStartFile);
+	else
+		remove(tempFileName);
+	free(firstFrames);
+	free(frames);
+	free(tempFileName);
+}
+
+// Hands the pages listed in the pool's warm start file to the prefetcher, as many as the pool has frames, the most
+// recently used first. A pool without a file starts cold.
+static void readWarmStartFile(BM_BufferPool *const bm)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	FILE *file = fopen(poolInfo->warmStartFile, "r");
+	if (file == NULL)
+		return;
+
+	PageNumber *pages = malloc(sizeof(PageNumber) * bm->numPages);
+	int numPages = 0;
+	PageNumber pageNum;
+	while (numPages < bm->numPages && fscanf(file, "%d", &pageNum) == 1)
+	{
+		if (pageNum >= 0)
+			pages[numPages++] = pageNum;
+	}
+	fclose(file);
+
+	if (numPages == 0)
+	{
+		free(pages);
+		return;
+	}
+	pthread_mutex_lock(&poolInfo->prefetchLatch);
+	poolInfo->warmPages = pages;
+	poolInfo->numWarmPages = numPages;
+	startPrefetcher(bm);
+	pthread_mutex_unlock(&poolInfo->prefetchLatch);
+}
+
+#pragma endregion
+
+// ***** BUFFER POOL FUNCTIONS ***** //
+#pragma region BUFFER POOL FUNCTIONS
+
+/*
+   This function creates and initializes the buffer pool
+*/
+extern RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
+						 const int numberOfPages, ReplacementStrategy strategy,
+						 void *stratData)
+{
+	return initBufferPoolWithOptions(bm, pageFileName, numberOfPages, strategy, stratData, NULL);
+}
 
-			setNewPageToPageFrame(pageFrame, page, currentIndex);
+// Returns the slab a page buffer was taken from
+static FrameSlab *findSlab(BufferPoolInfo *poolInfo, SM_PageHandle buffer)
+{
+	size_t slabSize;
+	FrameSlab *slab;
+	for (slab = poolInfo->frameSlabs; slab != NULL; slab = slab->next)
+	{
+		slabSize = (size_t)slab->numBuffers * poolInfo->fileHandle.pageSize;
+		if (buffer >= slab->buffers && buffer < slab->buffers + slabSize)
 			break;
+	}
+	return slab;
+}
+
+// Returns a page buffer that is no longer used to the list of unused buffers
+static void releasePageBuffer(BufferPoolInfo *poolInfo, SM_PageHandle buffer)
+{
+	findSlab(poolInfo, buffer)->numUnused++;
+	poolInfo->unusedBuffers[poolInfo->numUnusedBuffers++] = buffer;
+}
+
+// Fills buffers with count page buffers: the unused buffers first, the others are allocated as one new slab.
+// Returns false if there is no memory, no buffer is taken then.
+static bool takePageBuffers(BufferPoolInfo *poolInfo, SM_PageHandle *buffers, int count)
+{
+	int numReused = (count < poolInfo->numUnusedBuffers) ? count : poolInfo->numUnusedBuffers;
+	int numAllocated = count - numReused;
+	int iter;
+	if (numAllocated > 0)
+	{
+		FrameSlab *slab = malloc(sizeof(FrameSlab));
+		void *slabBuffers = NULL;
+		SM_PageHandle *unusedBuffers = realloc(poolInfo->unusedBuffers, sizeof(SM_PageHandle) * (poolInfo->numSlabBuffers + numAllocated));
+		if (unusedBuffers != NULL)
+			poolInfo->unusedBuffers = unusedBuffers;
+		if (slab == NULL || unusedBuffers == NULL ||
+			posix_memalign(&slabBuffers, SM_DIRECT_IO_ALIGNMENT, (size_t)numAllocated * poolInfo->fileHandle.pageSize) != 0)
+		{
+			free(slab);
+			return false;
 		}
+		slab->buffers = (char *)slabBuffers;
+		slab->numBuffers = numAllocated;
+		slab->numUnused = 0;
+		slab->next = poolInfo->frameSlabs;
+		poolInfo->frameSlabs = slab;
+		poolInfo->numSlabBuffers += numAllocated;
+		for (iter = 0; iter < numAllocated; iter++)
+			buffers[numReused + iter] = slab->buffers + (size_t)iter * poolInfo->fileHandle.pageSize;
+	}
+	for (iter = 0; iter < numReused; iter++)
+	{
+		buffers[iter] = poolInfo->unusedBuffers[--poolInfo->numUnusedBuffers];
+		findSlab(poolInfo, buffers[iter])->numUnused--;
 	}
+	return true;
 }
 
-// Implementing LRU (Least Recently Used) function
-extern void LRU(BM_BufferPool *const bm, PageFrame *page)
+// Releases the slabs none of whose buffers is used anymore
+static void freeUnusedSlabs(BufferPoolInfo *poolInfo)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-	int iter = 0, leastHitIndex, leastHitNum;
-
-	// set the least hit index to the first page frame
-	leastHitIndex = 0;
-	leastHitNum = pageFrame[0].hitNumber;
-
-	// Finding the least recently used page frame by finding the page frame with minimum hitNumber
-	for (iter = leastHitIndex + 1; iter < bufferSize; iter++)
+	FrameSlab **link = &poolInfo->frameSlabs;
+	while (*link != NULL)
 	{
-		if (pageFrame[iter].hitNumber < leastHitNum)
+		FrameSlab *slab = *link;
+		if (slab->numUnused < slab->numBuffers)
 		{
-			leastHitIndex = iter;
-			leastHitNum = pageFrame[iter].hitNumber;
+			link = &slab->next;
+			continue;
 		}
+
+		// Removing the buffers of the slab from the list of unused buffers
+		int numKept = 0;
+		int iter;
+		for (iter = 0; iter < poolInfo->numUnusedBuffers; iter++)
+			if (findSlab(poolInfo, poolInfo->unusedBuffers[iter]) != slab)
+				poolInfo->unusedBuffers[numKept++] = poolInfo->unusedBuffers[iter];
+		poolInfo->numUnusedBuffers = numKept;
+		poolInfo->numSlabBuffers -= slab->numBuffers;
+		*link = slab->next;
+		free(slab->buffers);
+		free(slab);
+	}
+}
+
+// Sets up the frames first .. last-1 of pageFrames as frames without a page, frame first gets buffers[0] and so on.
+// buffers is NULL for a zero-copy pool. Returns false if memory is missing, the frames can be released by freeFrame nevertheless.
+static bool initFrames(PageFrame *pageFrames, int first, int last, SM_PageHandle *buffers)
+{
+	bool allocated = true;
+	int iter;
+	for (iter = first; iter < last; iter++)
+	{
+		pageFrames[iter].data = (buffers != NULL) ? buffers[iter - first] : NULL;
+		pageFrames[iter].pageNum = NO_PAGE;
+		pageFrames[iter].isPageDirty = false;
+		pageFrames[iter].clientCount = 0;
+		pageFrames[iter].hashNext = -1;
+		pageFrames[iter].isLoading = false;
+		pageFrames[iter].writeBackPageNum = NO_PAGE;
+		pageFrames[iter].writeBackNext = -1;
+		pageFrames[iter].lastAccess = 0;
+		pageFrames[iter].isPrefetched = false;
+		pageFrames[iter].latch = malloc(sizeof(pthread_rwlock_t));
+		if (pageFrames[iter].latch != NULL)
+			pthread_rwlock_init(pageFrames[iter].latch, NULL);
+		else
+			allocated = false;
 	}
+	return allocated;
+}
 
-	// If page in memory has been modified then write the page to the disk
-	if (pageFrame[leastHitIndex].isPageDirty == true)
+// Releases the latch of a frame, its page buffer belongs to a slab of the pool
+static void freeFrame(PageFrame *frame)
+{
+	if (frame->latch != NULL)
 	{
-		writeBlockToDisk(bm, pageFrame, leastHitIndex);
+		pthread_rwlock_destroy(frame->latch);
+		free(frame->latch);
 	}
+}
 
-	// Setting page frame's content to new page's content
-	setNewPageToPageFrame(pageFrame, page, leastHitIndex);
+// Sets up a partition owning numFrames new frames with the page buffers buffers[0 .. numFrames-1] and the spare buffer
+// spareData (NULL for a zero-copy pool), returns false if memory is missing
+static bool initPartition(PoolPartition *partition, int numFrames, SM_PageHandle *buffers, SM_PageHandle spareData)
+{
+	partition->pageFrames = malloc(sizeof(PageFrame) * numFrames);
+	partition->numFrames = numFrames;
+	partition->spareData = spareData;
+	partition->numWriteBacks = 0;
+	partition->accessClock = 0;
+	partition->policyData = NULL;
+
+	// Every partition keeps its own replacement state and I/O counters
+	partition->numPagesReadCount = partition->totalDiskWriteCount = 0;
+	memset(&partition->stats, 0, sizeof(BM_PoolStats));
+	pthread_mutex_init(&partition->partitionLatch, NULL);
+	pthread_cond_init(&partition->frameLoaded, NULL);
+
+	// All frames are free, they are used in the order of their index
+	bool allocated = initFrames(partition->pageFrames, 0, numFrames, buffers);
+	partition->pageTable = NULL;
+	partition->writeBackTable = NULL;
+	partition->freeFrames = NULL;
+	indexFrames(partition);
+	return allocated;
+}
+
+// Number of frames a shrink can drop from a partition: frames without a page and frames holding a clean page nobody uses.
+// Called with the partition latch held.
+static int countRemovableFrames(PoolPartition *partition)
+{
+	int numRemovable = 0;
+	int iter;
+	for (iter = 0; iter < partition->numFrames; iter++)
+	{
+		PageFrame *frame = &partition->pageFrames[iter];
+		if (frame->pageNum == NO_PAGE || (frame->clientCount == 0 && !frame->isPageDirty && !frame->isLoading))
+			numRemovable++;
+	}
+	return numRemovable;
 }
 
-// Implementing CLOCK function
-extern void CLOCK(BM_BufferPool *const bm, PageFrame *page)
+// Moves the frames of a partition into newFrames, an array of newNumFrames frames in which the frames added by a grow
+// are already set up. A shrink drops frames without a page first, then frames holding a clean page nobody uses, the
+// partition has enough of them (see countRemovableFrames); their buffers are kept for the next grow. The frames that
+// stay keep their page, fix count, latch and buffer, only their index changes, frameMap (one entry per old frame) is
+// filled with the new indexes. newPolicyData replaces the replacement state and takes over what the old state knows
+// about the frames that stay. Called with the partition latch held, returns the old state.
+static void *resizePartition(BufferPoolInfo *poolInfo, PoolPartition *partition, PageFrame *newFrames, int newNumFrames,
+							 void *newPolicyData, int *frameMap)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-	while (true)
+	PageFrame *pageFrame = partition->pageFrames;
+	int numFrames = partition->numFrames;
+	int numFreeToDrop = 0;
+	int numCleanToDrop = 0;
+	if (newNumFrames < numFrames)
 	{
-		// Resetting clock pointer
-		if (clockPointer % bufferSize == 0)
-			clockPointer = 0;
+		numFreeToDrop = numFrames - newNumFrames;
+		if (numFreeToDrop > partition->numFreeFrames)
+			numFreeToDrop = partition->numFreeFrames;
+		numCleanToDrop = numFrames - newNumFrames - numFreeToDrop;
+	}
 
-		// if hitnum is zero then set a new page into the page frame
-		if (pageFrame[clockPointer].hitNumber == 0)
+	int iter;
+	int numKept = 0;
+	for (iter = 0; iter < numFrames; iter++)
+	{
+		bool drop = false;
+		if (pageFrame[iter].pageNum == NO_PAGE && numFreeToDrop > 0)
 		{
-			// If page in memory has been modified then write the page to the disk
-			if (pageFrame[clockPointer].isPageDirty == true)
-			{
-				writeBlockToDisk(bm, pageFrame, clockPointer);
-			}
+			numFreeToDrop--;
+			drop = true;
+		}
+		else if (pageFrame[iter].pageNum != NO_PAGE && pageFrame[iter].clientCount == 0 && !pageFrame[iter].isPageDirty &&
+				 !pageFrame[iter].isLoading && numCleanToDrop > 0)
+		{
+			numCleanToDrop--;
+			drop = true;
+		}
 
-			// Setting page frame's content to new page's content
-			setNewPageToPageFrame(pageFrame, page, clockPointer);
-			clockPointer++;
-			break;
+		if (drop)
+		{
+			frameMap[iter] = -1;
+			if (!poolInfo->zeroCopy)
+				releasePageBuffer(poolInfo, pageFrame[iter].data);
+			freeFrame(&pageFrame[iter]);
 		}
 		else
 		{
-			// setting hitNumber = 0 to terminate infinite looping
-			pageFrame[clockPointer].hitNumber = 0;
-			clockPointer++;
+			frameMap[iter] = numKept;
+			newFrames[numKept++] = pageFrame[iter];
 		}
 	}
-}
 
-#pragma endregion
+	free(partition->pageFrames);
+	partition->pageFrames = newFrames;
+	partition->numFrames = newNumFrames;
+	partition->policyView.numPages = newNumFrames;
+	indexFrames(partition);
 
-// ***** BUFFER POOL FUNCTIONS ***** //
-#pragma region BUFFER POOL FUNCTIONS
+	// A policy without a resize hook learns the pages in the partition again in the order of their frames
+	void *oldPolicyData = partition->policyData;
+	partition->policyData = newPolicyData;
+	if (poolInfo->policy->resize != NULL)
+	{
+		poolInfo->policy->resize(oldPolicyData, newPolicyData, frameMap, numFrames);
+		return oldPolicyData;
+	}
+	for (iter = 0; iter < newNumFrames; iter++)
+	{
+		if (newFrames[iter].pageNum == NO_PAGE)
+			continue;
+		poolInfo->policy->onLoad(partition->policyData, iter, newFrames[iter].pageNum);
+		if (newFrames[iter].clientCount == 0 && poolInfo->policy->onUnpin != NULL)
+			poolInfo->policy->onUnpin(partition->policyData, iter);
+	}
+	return oldPolicyData;
+}
 
 /*
-   This function creates and initializes the buffer pool
+   This function creates a buffer pool with optional settings, options may be NULL for the defaults
 */
-extern RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName,
-						 const int numberOfPages, ReplacementStrategy strategy,
-						 void *stratData)
+extern RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+									const int numberOfPages, ReplacementStrategy strategy,
+									void *stratData, const BM_PoolOptions *const options)
 {
-	// memory allocation for the pageFrame
-	PageFrame *page = malloc(sizeof(PageFrame) * numberOfPages);
+	bool zeroCopy = (options != NULL && options->zeroCopy);
+	bool directIO = (options != NULL && options->directIO);
+	int numPartitions = (options != NULL && options->numPartitions > 1) ? options->numPartitions : 1;
+	bm->mgmtData = NULL;
 
-	bufferSize = numberOfPages;
-	int iter = 0;
+	// A read-only mapping is served from the page cache, it cannot be combined with O_DIRECT
+	if (zeroCopy && directIO)
+		return RC_ERROR;
+
+	// Every partition needs at least one frame
+	if (numPartitions > numberOfPages)
+		return RC_ERROR;
+
+	// The background writer keeps a percentage of the frames clean
+	if (options != NULL && (options->cleanFramesPercent < 0 || options->cleanFramesPercent > 100))
+		return RC_ERROR;
+
+	// The replacement policy given in the options replaces the built-in policy of the strategy
+	const BM_ReplacementPolicy *policy = (options != NULL && options->policy != NULL) ? options->policy : getReplacementPolicy(strategy);
+	if (policy == NULL)
+		return RC_ERROR;
+
+	BufferPoolInfo *poolInfo = malloc(sizeof(BufferPoolInfo));
+	poolInfo->zeroCopy = zeroCopy;
+	poolInfo->hasStratData = (stratData != NULL);
+	poolInfo->frameSlabs = NULL;
+	poolInfo->unusedBuffers = NULL;
+	poolInfo->numUnusedBuffers = poolInfo->numSlabBuffers = 0;
+	poolInfo->asyncContext = NULL;
+	poolInfo->policy = policy;
+	poolInfo->cleanFramesPercent = (options != NULL) ? options->cleanFramesPercent : 0;
+	poolInfo->isWriterRunning = false;
+	poolInfo->isPrefetcherRunning = false;
+	poolInfo->prefetchHead = poolInfo->prefetchLength = 0;
+	poolInfo->readAheadPages = (options != NULL && options->readAheadPages > 0) ? options->readAheadPages : 0;
+	poolInfo->lastPinnedPage = NO_PAGE;
+	poolInfo->sequentialPins = 0;
+	poolInfo->readAheadEnd = 0;
+	poolInfo->warmStartFile = (options != NULL && options->warmStartFile != NULL) ? strdup(options->warmStartFile) : NULL;
+	poolInfo->warmPages = NULL;
+	poolInfo->numWarmPages = 0;
+
+	// The page file stays open until the pool is shut down. Zero-copy pools map it read-only.
+	SM_IOMode ioMode = zeroCopy ? SM_IO_MMAP_READ_ONLY : (directIO ? SM_IO_DIRECT : SM_IO_PREAD);
+	RC result = openPageFileWithMode((char *)pageFileName, &poolInfo->fileHandle, ioMode);
+	if (result != RC_OK)
+	{
+		free(poolInfo->warmStartFile);
+		free(poolInfo);
+		return result;
+	}
 
-	// Intilalizing all pages in the buffer pool with default values.
-	while (iter < bufferSize)
+	// Frames hold pages of the size the page file was created with
+	int pageSize = poolInfo->fileHandle.pageSize;
+
+	pthread_mutex_init(&poolInfo->fileLatch, NULL);
+	pthread_mutex_init(&poolInfo->resizeLatch, NULL);
+	pthread_mutex_init(&poolInfo->writerLatch, NULL);
+	pthread_cond_init(&poolInfo->writerWakeup, NULL);
+	pthread_mutex_init(&poolInfo->prefetchLatch, NULL);
+	pthread_cond_init(&poolInfo->prefetchWakeup, NULL);
+
+	// The frames are split evenly, the first partitions get one frame more if they do not divide. The page buffers of
+	// all frames and one spare buffer for every partition are allocated as one slab.
+	SM_PageHandle *buffers = NULL;
+	bool allocated = true;
+	if (!zeroCopy)
+	{
+		buffers = malloc(sizeof(SM_PageHandle) * (numberOfPages + numPartitions));
+		if (buffers == NULL || !takePageBuffers(poolInfo, buffers, numberOfPages + numPartitions))
+		{
+			free(buffers);
+			buffers = NULL;
+			allocated = false;
+		}
+	}
+	poolInfo->numPartitions = numPartitions;
+	poolInfo->partitions = malloc(sizeof(PoolPartition) * numPartitions);
+	int firstFrame = 0;
+	int iter;
+	for (iter = 0; iter < numPartitions; iter++)
 	{
-		page[iter].data = NULL;
-		page[iter].pageNum = -1;
-		page[iter].isPageDirty = false;
-		page[iter].clientCount = 0;
-		page[iter].hitNumber = 0;
-		page[iter].refNumber = 0;
-		iter++;
+		int numFrames = numberOfPages / numPartitions + (iter < numberOfPages % numPartitions ? 1 : 0);
+		if (!initPartition(&poolInfo->partitions[iter], numFrames, (buffers != NULL) ? buffers + firstFrame : NULL,
+						   (buffers != NULL) ? buffers[numberOfPages + iter] : NULL))
+			allocated = false;
+		firstFrame += numFrames;
 	}
+	free(buffers);
+	bm->mgmtData = poolInfo;
 
-	bm->mgmtData = page;
+	// Pools that do their own I/O use an asynchronous engine when one is available, synchronous I/O otherwise
+	if (!poolInfo->zeroCopy && initAsyncIO(&poolInfo->asyncContext, 0) != RC_OK)
+		poolInfo->asyncContext = NULL;
 	bm->pageFile = (char *)pageFileName;
 	bm->numPages = numberOfPages;
+	bm->pageSize = pageSize;
 	bm->strategy = strategy;
 
-	totalDiskWriteCount = clockPointer = 0;
+	// A pool that could not be set up does not replace the list of the last warm start
+	if (!allocated)
+	{
+		free(poolInfo->warmStartFile);
+		poolInfo->warmStartFile = NULL;
+		shutdownBufferPool(bm);
+		return RC_MELLOC_MEM_ALLOC_FAILED;
+	}
+
+	// The replacement policy of every partition only sees the frames of its partition
+	for (iter = 0; iter < numPartitions; iter++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		partition->policyView = *bm;
+		partition->policyView.numPages = partition->numFrames;
+		partition->policyView.mgmtData = partition;
+		if ((result = policy->init(&partition->policyData, partition->numFrames, stratData)) != RC_OK)
+		{
+			partition->policyData = NULL;
+			free(poolInfo->warmStartFile);
+			poolInfo->warmStartFile = NULL;
+			shutdownBufferPool(bm);
+			return result;
+		}
+	}
+
+	// Pages of a zero-copy pool are never dirty, there is nothing to write in the background
+	if (poolInfo->cleanFramesPercent > 0 && !poolInfo->zeroCopy)
+		startBackgroundWriter(bm);
+
+	// The pages that were in the pool at the last shutdown are read in the background, zero-copy pools read no pages
+	if (poolInfo->warmStartFile != NULL && !poolInfo->zeroCopy)
+		readWarmStartFile(bm);
 	return RC_OK;
 }
 
 // shutdownBufferPool implements closing of the buffer pool, i.e. removing all the pages from the memory and freeing up the unused memory space.
 extern RC shutdownBufferPool(BM_BufferPool *const bm)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	// The prefetcher and the background writer are stopped first, the pages they are reading or writing are pinned.
+	// A prefetcher is started again by the next prefetch request.
+	stopPrefetcher(bm);
+	bool wasWriterRunning = poolInfo->isWriterRunning;
+	stopBackgroundWriter(poolInfo);
+
 	// Write all dirty pages (modified pages) back to disk
 	forceFlushPool(bm);
 
-	int iter = 0;
+	int iter;
+	int frameIndex;
 	// check if any page in the buffer pool has an active user
-	while (iter < bufferSize)
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
 	{
-		// The iterated page still has active users
-		if (pageFrame[iter].clientCount != 0)
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		for (frameIndex = 0; frameIndex < partition->numFrames; frameIndex++)
 		{
-			return RC_PINNED_PAGES_IN_BUFFER;
+			// The iterated page still has active users, the pool stays as it was
+			if (partition->pageFrames[frameIndex].clientCount != 0)
+			{
+				if (wasWriterRunning)
+					startBackgroundWriter(bm);
+				return RC_PINNED_PAGES_IN_BUFFER;
+			}
 		}
-		iter++;
 	}
 
-	// Releasing space occupied by the page Frame
-	free(pageFrame);
+	// The pages in the pool are listed for the next warm start
+	if (poolInfo->warmStartFile != NULL)
+		writeWarmStartFile(bm);
+
+	// Releasing the page Frames, the partitions and closing the page file
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		for (frameIndex = 0; frameIndex < partition->numFrames; frameIndex++)
+			freeFrame(&partition->pageFrames[frameIndex]);
+		free(partition->pageFrames);
+		free(partition->pageTable);
+		free(partition->writeBackTable);
+		free(partition->freeFrames);
+		if (partition->policyData != NULL && poolInfo->policy->shutdown != NULL)
+			poolInfo->policy->shutdown(partition->policyData);
+		pthread_mutex_destroy(&partition->partitionLatch);
+		pthread_cond_destroy(&partition->frameLoaded);
+	}
+	free(poolInfo->partitions);
+
+	// Releasing the page buffers of the frames
+	while (poolInfo->frameSlabs != NULL)
+	{
+		FrameSlab *slab = poolInfo->frameSlabs;
+		poolInfo->frameSlabs = slab->next;
+		free(slab->buffers);
+		free(slab);
+	}
+	free(poolInfo->unusedBuffers);
+	pthread_mutex_destroy(&poolInfo->fileLatch);
+	pthread_mutex_destroy(&poolInfo->resizeLatch);
+	pthread_mutex_destroy(&poolInfo->writerLatch);
+	pthread_cond_destroy(&poolInfo->writerWakeup);
+	pthread_mutex_destroy(&poolInfo->prefetchLatch);
+	pthread_cond_destroy(&poolInfo->prefetchWakeup);
+	if (poolInfo->asyncContext != NULL)
+		shutdownAsyncIO(poolInfo->asyncContext);
+	closePageFile(&poolInfo->fileHandle);
+	free(poolInfo->warmPages);
+	free(poolInfo->warmStartFile);
+	free(poolInfo);
 	bm->mgmtData = NULL;
 	return RC_OK;
 }
@@ -250,26 +2046,149 @@ extern RC shutdownBufferPool(BM_BufferPool *const bm)
 // forceFlushPool function writes all the dirty pages back to the disk
 extern RC forceFlushPool(BM_BufferPool *const bm)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
 
-	int iter = 0;
-	// Store all dirty pages (modified pages) in memory to page file on disk
-	while (iter < bufferSize)
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	DirtyPage *dirtyPages = NULL;
+	int capacity = 0;
+	int numDirty = 0;
+
+	// Collecting all dirty pages (modified pages) that are currently not being used, from every partition
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+	{
+		pthread_mutex_lock(&poolInfo->partitions[iter].partitionLatch);
+		numDirty = collectDirtyFrames(&poolInfo->partitions[iter], &dirtyPages, &capacity, numDirty);
+		pthread_mutex_unlock(&poolInfo->partitions[iter].partitionLatch);
+	}
+
+	RC result = writeDirtyFrames(bm, dirtyPages, numDirty);
+	free(dirtyPages);
+	return result;
+}
+
+// resizeBufferPool changes the number of frames of the pool to newNumPages while clients keep using it
+extern RC resizeBufferPool(BM_BufferPool *const bm, const int newNumPages)
+{
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Every partition keeps at least one frame
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	if (newNumPages < poolInfo->numPartitions)
+		return RC_ERROR;
+
+	pthread_mutex_lock(&poolInfo->resizeLatch);
+	int numPartitions = poolInfo->numPartitions;
+	PageFrame **newFrames = malloc(sizeof(PageFrame *) * numPartitions);
+	void **policyData = malloc(sizeof(void *) * numPartitions);
+	int **frameMaps = malloc(sizeof(int *) * numPartitions);
+	int *newNumFrames = malloc(sizeof(int) * numPartitions);
+	RC result = RC_OK;
+
+	// The frames are split evenly like in initBufferPoolWithOptions. The frames a grow adds get the buffers earlier
+	// shrinks dropped, the others are allocated as one slab.
+	int numGrown = 0;
+	int iter;
+	for (iter = 0; iter < numPartitions; iter++)
+	{
+		newNumFrames[iter] = newNumPages / numPartitions + (iter < newNumPages % numPartitions ? 1 : 0);
+		if (newNumFrames[iter] > poolInfo->partitions[iter].numFrames)
+			numGrown += newNumFrames[iter] - poolInfo->partitions[iter].numFrames;
+	}
+	SM_PageHandle *grownBuffers = NULL;
+	if (!poolInfo->zeroCopy && numGrown > 0)
 	{
-		// Check if page in the buffer pool is currently not being used and also it is dirty
-		if (pageFrame[iter].clientCount == 0 && pageFrame[iter].isPageDirty == true)
+		grownBuffers = malloc(sizeof(SM_PageHandle) * numGrown);
+		if (grownBuffers == NULL || !takePageBuffers(poolInfo, grownBuffers, numGrown))
 		{
-			SM_FileHandle fh;
-			openPageFile(bm->pageFile, &fh);
-			// Writing pageFrame data to the page file on disk
-			writeBlock(pageFrame[iter].pageNum, &fh, pageFrame[iter].data);
-			// Mark the page not dirty.
-			pageFrame[iter].isPageDirty = false;
-			totalDiskWriteCount++;
+			free(grownBuffers);
+			grownBuffers = NULL;
+			result = RC_MELLOC_MEM_ALLOC_FAILED;
 		}
-		iter++;
 	}
-	return RC_OK;
+
+	// The frames a partition gets and the replacement states for the new frame counts are created before any partition
+	// latch is taken
+	int numPrepared;
+	int firstGrown = 0;
+	for (numPrepared = 0; numPrepared < numPartitions && result == RC_OK; numPrepared++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[numPrepared];
+		newFrames[numPrepared] = malloc(sizeof(PageFrame) * newNumFrames[numPrepared]);
+		frameMaps[numPrepared] = malloc(sizeof(int) * partition->numFrames);
+		policyData[numPrepared] = NULL;
+		if (newNumFrames[numPrepared] > partition->numFrames)
+		{
+			bool allocated = initFrames(newFrames[numPrepared], partition->numFrames, newNumFrames[numPrepared],
+										(grownBuffers != NULL) ? grownBuffers + firstGrown : NULL);
+			firstGrown += newNumFrames[numPrepared] - partition->numFrames;
+			if (!allocated)
+			{
+				result = RC_MELLOC_MEM_ALLOC_FAILED;
+				continue;
+			}
+		}
+		if (poolInfo->policy->initFrom != NULL)
+			result = poolInfo->policy->initFrom(partition->policyData, &policyData[numPrepared], newNumFrames[numPrepared]);
+		else
+			result = poolInfo->hasStratData ? RC_ERROR : poolInfo->policy->init(&policyData[numPrepared], newNumFrames[numPrepared], NULL);
+		if (result != RC_OK)
+			policyData[numPrepared] = NULL;
+	}
+
+	// The frames a shrink drops have to hold clean pages, the dirty pages are written back first
+	if (result == RC_OK && newNumPages < bm->numPages)
+		forceFlushPool(bm);
+
+	// The frames are swapped with all partition latches held, clients only wait for the bookkeeping and never for I/O.
+	// Clients keep the pages they have pinned, their buffers do not move.
+	lockPartitions(poolInfo);
+	for (iter = 0; iter < numPartitions && result == RC_OK; iter++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		if (countRemovableFrames(partition) < partition->numFrames - newNumFrames[iter])
+			result = RC_PINNED_PAGES_IN_BUFFER;
+	}
+	if (result == RC_OK)
+	{
+		for (iter = 0; iter < numPartitions; iter++)
+			policyData[iter] = resizePartition(poolInfo, &poolInfo->partitions[iter], newFrames[iter], newNumFrames[iter],
+											   policyData[iter], frameMaps[iter]);
+		__atomic_store_n(&bm->numPages, newNumPages, __ATOMIC_RELAXED);
+	}
+	unlockPartitions(poolInfo);
+
+	// Releasing the old replacement states, or everything that was prepared if the pool could not be resized
+	for (iter = 0; iter < numPrepared; iter++)
+	{
+		if (policyData[iter] != NULL && poolInfo->policy->shutdown != NULL)
+			poolInfo->policy->shutdown(policyData[iter]);
+		if (result != RC_OK)
+		{
+			int frameIndex;
+			for (frameIndex = poolInfo->partitions[iter].numFrames; frameIndex < newNumFrames[iter]; frameIndex++)
+				freeFrame(&newFrames[iter][frameIndex]);
+			free(newFrames[iter]);
+		}
+		free(frameMaps[iter]);
+	}
+	if (result != RC_OK && grownBuffers != NULL)
+	{
+		for (iter = 0; iter < numGrown; iter++)
+			releasePageBuffer(poolInfo, grownBuffers[iter]);
+	}
+	freeUnusedSlabs(poolInfo);
+	free(grownBuffers);
+	free(newNumFrames);
+	free(frameMaps);
+	free(policyData);
+	free(newFrames);
+	pthread_mutex_unlock(&poolInfo->resizeLatch);
+	return result;
 }
 
 #pragma endregion
@@ -280,184 +2199,394 @@ extern RC forceFlushPool(BM_BufferPool *const bm)
 // markDirty function marks modified page as dirty
 extern RC markDirty(BM_BufferPool *const bm, BM_PageHandle *const page)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	// Pages of a zero-copy pool live in a read-only mapping and can never be modified
+	if (((BufferPoolInfo *)bm->mgmtData)->zeroCopy)
+		return RC_WRITE_FAILED;
 
-	int iter = 0;
-	// Iterating through all the pages in the buffer pool
-	while (iter < bufferSize)
+	PoolPartition *partition = getPartition((BufferPoolInfo *)bm->mgmtData, page->pageNum);
+
+	// Looking the page up in the page table of its partition
+	pthread_mutex_lock(&partition->partitionLatch);
+	int frameIndex = findFrame(partition, page->pageNum);
+
+	// control reaches here only when the page is not found in the pageFrame
+	if (frameIndex == -1)
 	{
-		// If the current page is the page to be marked dirty
-		if (pageFrame[iter].pageNum == page->pageNum)
-		{
-			pageFrame[iter].isPageDirty = true;
-			return RC_OK;
-		}
-		iter++;
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return RC_ERROR;
 	}
-	// control reaches here only when the page is not found in the pageFrame
-	return RC_ERROR;
+
+	setFrameDirty(partition, frameIndex, true);
+	pthread_mutex_unlock(&partition->partitionLatch);
+	return RC_OK;
 }
 
 // unpinPage function removes a page from the memory
 extern RC unpinPage(BM_BufferPool *const bm, BM_PageHandle *const page)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PoolPartition *partition = getPartition(poolInfo, page->pageNum);
 
-	int iter = 0;
-	// Iterating through all the pages in the buffer pool
-	while (iter < bufferSize)
+	// Looking the page up in the page table of its partition
+	pthread_mutex_lock(&partition->partitionLatch);
+	int frameIndex = findFrame(partition, page->pageNum);
+
+	// control reaches here only when the page is not found in the pageFrame
+	if (frameIndex == -1)
 	{
-		if (pageFrame[iter].pageNum == page->pageNum)
-		{
-			// removes one client from the client count
-			pageFrame[iter].clientCount--;
-			break;
-		}
-		iter++;
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return RC_ERROR;
 	}
+
+	// removes one client from the client count, the replacement policy may evict the frame again once no client uses it anymore
+	unpinFrame(poolInfo, partition, frameIndex);
+	pthread_mutex_unlock(&partition->partitionLatch);
 	return RC_OK;
 }
 
 // This function writes the contents of the modified pages back to the page file on disk
 extern RC forcePage(BM_BufferPool *const bm, BM_PageHandle *const page)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PoolPartition *partition = getPartition(poolInfo, page->pageNum);
 
-	int iter = 0;
-	// Iterating through all the pages in the buffer pool
-	while (iter < bufferSize)
+	// Looking the page up in the page table of its partition, a page that is being read is written once it is there
+	pthread_mutex_lock(&partition->partitionLatch);
+	int frameIndex;
+	while ((frameIndex = findFrame(partition, page->pageNum)) != -1 && partition->pageFrames[frameIndex].isLoading)
+		pthread_cond_wait(&partition->frameLoaded, &partition->partitionLatch);
+	PageFrame *pageFrame = partition->pageFrames;
+
+	// control reaches here only when the page is not found in the pageFrame
+	if (frameIndex == -1)
 	{
-		if (pageFrame[iter].pageNum == page->pageNum)
-		{
-			writeBlockToDisk(bm, pageFrame, iter);
-			// Mark page as undirty because the modified page has been written to disk
-			pageFrame[iter].isPageDirty = false;
-		}
-		iter++;
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return RC_ERROR;
 	}
-	return RC_OK;
+
+	// The page is pinned while it is written, so that it is not evicted. Mark page as undirty, modifications
+	// made from now on are written by a later flush.
+	pinFrame(partition, frameIndex);
+	setFrameDirty(partition, frameIndex, false);
+	SM_PageHandle data = pageFrame[frameIndex].data;
+	pthread_rwlock_t *latch = pageFrame[frameIndex].latch;
+	pthread_mutex_unlock(&partition->partitionLatch);
+
+	// The page is latched shared while it is written, so that nobody modifies it meanwhile. A client that latched the
+	// page exclusively itself (the latch reports the deadlock) is the only one that could modify it.
+	bool isLatched = (pthread_rwlock_rdlock(latch) == 0);
+	RC result = writeBlockToDisk(bm, partition, page->pageNum, data);
+	if (isLatched)
+		pthread_rwlock_unlock(latch);
+
+	// The pinned page kept its frame, which may have moved in a resize meanwhile
+	pthread_mutex_lock(&partition->partitionLatch);
+	pageFrame = partition->pageFrames;
+	frameIndex = findFrame(partition, page->pageNum);
+	if (result != RC_OK)
+		setFrameDirty(partition, frameIndex, true);
+	addCount(&partition->stats.flushedPages, 1);
+	unpinFrame(poolInfo, partition, frameIndex);
+	pthread_mutex_unlock(&partition->partitionLatch);
+	return result;
 }
 
 // pinPage function pins a page pageNum into the buffer pool
 extern RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page,
 				  const PageNumber pageNum)
 {
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-	PageFrame *newPage = (PageFrame *)malloc(sizeof(PageFrame));
-	const int firstPagePOS = 0;
-	// Checking if buffer pool is empty and if its the first page to be pinned
-	if (pageFrame[firstPagePOS].pageNum == -1)
-	{
-		numPagesReadCount = hit = 0;
-		SM_FileHandle fh;
-		openPageFile(bm->pageFile, &fh);
-		pageFrame[firstPagePOS].data = (SM_PageHandle)malloc(PAGE_SIZE);
-		ensureCapacity(pageNum, &fh);
-		readBlock(pageNum, &fh, pageFrame[firstPagePOS].data);
-		pageFrame[firstPagePOS].pageNum = pageNum;
-		pageFrame[firstPagePOS].clientCount++;
-		pageFrame[firstPagePOS].hitNumber = hit;
-		pageFrame[firstPagePOS].refNumber = 0;
-		page->pageNum = pageNum;
-		page->data = pageFrame[0].data;
+	return pinPageWithStrategy(bm, page, pageNum, NULL);
+}
+
+// initAccessStrategy creates the ring of an access strategy, the ring holds up to ringSize frames
+extern RC initAccessStrategy(BM_AccessStrategy *const access, const int ringSize)
+{
+	if (ringSize < 1)
+		return RC_ERROR;
 
-		return RC_OK;
+	access->ringFrames = malloc(sizeof(int) * ringSize);
+	access->ringPages = malloc(sizeof(PageNumber) * ringSize);
+	if (access->ringFrames == NULL || access->ringPages == NULL)
+	{
+		free(access->ringFrames);
+		free(access->ringPages);
+		access->ringFrames = NULL;
+		access->ringPages = NULL;
+		return RC_MELLOC_MEM_ALLOC_FAILED;
+	}
+
+	// All slots of the ring are empty
+	int iter;
+	for (iter = 0; iter < ringSize; iter++)
+	{
+		access->ringFrames[iter] = -1;
+		access->ringPages[iter] = NO_PAGE;
 	}
+	access->ringSize = ringSize;
+	access->nextSlot = 0;
+	return RC_OK;
+}
 
-	// Initially set the buffer pool as Full.
-	bool isBufferPoolFull = true;
+// freeAccessStrategy releases the ring of an access strategy, the pages it loaded stay in the pool
+extern RC freeAccessStrategy(BM_AccessStrategy *const access)
+{
+	free(access->ringFrames);
+	free(access->ringPages);
+	access->ringFrames = NULL;
+	access->ringPages = NULL;
+	access->ringSize = 0;
+	return RC_OK;
+}
 
-	int iter = 0;
-	// If there is any empty frame in the pool or if the expected pageNum is available then set the buffer pool as not Full.
-	while (iter < bufferSize)
-	{
-		// Ckeck if the page is empty
-		if (pageFrame[iter].pageNum == -1) {
-			SM_FileHandle fh;
-			openPageFile(bm->pageFile, &fh);
-			pageFrame[iter].data = (SM_PageHandle)malloc(PAGE_SIZE);
-			readBlock(pageNum, &fh, pageFrame[iter].data);
-			pageFrame[iter].pageNum = pageNum;
-			pageFrame[iter].clientCount = 1;
-			pageFrame[iter].refNumber = 0;
-			numPagesReadCount++;
-			hit++;
-
-			if (bm->strategy == RS_LRU)
-				pageFrame[iter].hitNumber = hit;
-			else if (bm->strategy == RS_CLOCK)
-				pageFrame[iter].hitNumber = 1;
+// pinPageWithStrategy pins page pageNum like pinPage. If the page has to be read, access (may be NULL) recycles a frame of its ring.
+extern RC pinPageWithStrategy(BM_BufferPool *const bm, BM_PageHandle *const page,
+							  const PageNumber pageNum, BM_AccessStrategy *const access)
+{
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
 
-			page->pageNum = pageNum;
-			page->data = pageFrame[iter].data;
+	// A negative page number does not exist, NO_PAGE marks frames without a page
+	if (pageNum < 0)
+		return RC_READ_NON_EXISTING_PAGE;
 
-			isBufferPoolFull = false;
-			break;
-		}
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PoolPartition *partition = getPartition(poolInfo, pageNum);
+
+	// Pins of adjacent pages start a read-ahead
+	if (poolInfo->readAheadPages > 0)
+		noteSequentialPin(bm, pageNum, access);
 
-		// Control reaches here only if the page frame is not empty
-		// Now check if the page is in memory
-		if (pageFrame[iter].pageNum == pageNum)
+	pthread_mutex_lock(&partition->partitionLatch);
+
+	// Checking if the page is already in memory, the page table finds its frame without iterating through the pool
+	int iter;
+	long waitStartMicros = -1;
+	while ((iter = findFrame(partition, pageNum)) != -1 || isWriteBackInFlight(partition, pageNum))
+	{
+		PageFrame *pageFrame = partition->pageFrames;
+		if (iter != -1 && !pageFrame[iter].isLoading)
 		{
-			isBufferPoolFull = false;
-			hit++;
 			// One more client is accessing this page
-			pageFrame[iter].clientCount++;
+			pinFrame(partition, iter);
+			pageFrame[iter].lastAccess = ++partition->accessClock;
+			countHit(partition, &pageFrame[iter]);
+			countPinWait(partition, waitStartMicros);
 
-			if (bm->strategy == RS_LRU)
-				pageFrame[iter].hitNumber = hit;
-			else if (bm->strategy == RS_CLOCK)
-				pageFrame[iter].hitNumber = 1;
+			if (poolInfo->policy->onHit != NULL)
+				poolInfo->policy->onHit(partition->policyData, iter);
 
 			page->pageNum = pageNum;
 			page->data = pageFrame[iter].data;
+			pthread_mutex_unlock(&partition->partitionLatch);
+			return RC_OK;
+		}
 
-			clockPointer++;
-			break;
+		// Another client is reading the page, or writing it back after evicting it
+		if (waitStartMicros == -1)
+			waitStartMicros = getMicros();
+		pthread_cond_wait(&partition->frameLoaded, &partition->partitionLatch);
+	}
+	countPinWait(partition, waitStartMicros);
+
+	// The page has to be read from disk, into an empty frame or the frame of a page chosen by the replacement policy
+	return loadPage(bm, partition, page, pageNum, access);
+}
+
+// pinPages pins the pages pageNums[0 .. numPages-1] into the handles pages[0 .. numPages-1]. Hits are resolved with one
+// latch acquisition per run of pages of the same partition, the frames of all misses are taken before their pages
+// are read together. If a page cannot be pinned, none of them stays pinned.
+extern RC pinPages(BM_BufferPool *const bm, BM_PageHandle *const pages, const PageNumber *const pageNums, const int numPages)
+{
+	// Checking if the buffer pool was initialized
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+	if (numPages < 0)
+		return RC_ERROR;
+
+	// No handle has a page yet. A negative page number does not exist (NO_PAGE marks frames without a page).
+	RC result = RC_OK;
+	int iter;
+	for (iter = 0; iter < numPages; iter++)
+	{
+		pages[iter].pageNum = NO_PAGE;
+		pages[iter].data = NULL;
+		if (pageNums[iter] < 0)
+			result = RC_READ_NON_EXISTING_PAGE;
+	}
+	if (result != RC_OK)
+		return result;
+
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	FrameLoad *loads = malloc(sizeof(FrameLoad) * numPages);
+	int *loadPages = malloc(sizeof(int) * numPages);
+	int *waitingPages = malloc(sizeof(int) * numPages);
+	int numLoads = 0;
+	int numWaiting = 0;
+
+	// Pinning the hits and taking frames for the misses
+	PoolPartition *lockedPartition = NULL;
+	for (iter = 0; iter < numPages; iter++)
+	{
+		if (result != RC_OK)
+			continue;
+
+		PoolPartition *partition = getPartition(poolInfo, pageNums[iter]);
+		if (partition != lockedPartition)
+		{
+			if (lockedPartition != NULL)
+				pthread_mutex_unlock(&lockedPartition->partitionLatch);
+			pthread_mutex_lock(&partition->partitionLatch);
+			lockedPartition = partition;
+		}
+
+		PageFrame *pageFrame = partition->pageFrames;
+		int frameIndex = findFrame(partition, pageNums[iter]);
+		if (frameIndex != -1 && !pageFrame[frameIndex].isLoading)
+		{
+			// One more client is accessing this page
+			pinFrame(partition, frameIndex);
+			pageFrame[frameIndex].lastAccess = ++partition->accessClock;
+			countHit(partition, &pageFrame[frameIndex]);
+			if (poolInfo->policy->onHit != NULL)
+				poolInfo->policy->onHit(partition->policyData, frameIndex);
+			pages[iter].pageNum = pageNums[iter];
+			pages[iter].data = pageFrame[frameIndex].data;
+		}
+		else if (frameIndex != -1 || isWriteBackInFlight(partition, pageNums[iter]))
+		{
+			// The page is being read (maybe for an earlier handle of this call) or written back, it is pinned once that finished
+			waitingPages[numWaiting++] = iter;
 		}
-		iter++;
-	}
-
-	// Post iterating through the entire buffer pool, If isBufferPoolFull = true, then it means that the buffer is full and we must replace an existing page using page replacement strategy
-	if (isBufferPoolFull == true)
-	{
-		// Create a new page to store data read from the file.
-		PageFrame *newPage = (PageFrame *)malloc(sizeof(PageFrame));
-
-		// Reading page from disk and initializing page frame's content in the buffer pool
-		SM_FileHandle fh;
-		openPageFile(bm->pageFile, &fh);
-		newPage->data = (SM_PageHandle)malloc(PAGE_SIZE);
-		readBlock(pageNum, &fh, newPage->data);
-		newPage->pageNum = pageNum;
-		newPage->isPageDirty = false;
-		newPage->clientCount = 1;
-		newPage->refNumber = 0;
-		numPagesReadCount++;
-		hit++;
-
-		if (bm->strategy == RS_LRU)
-			newPage->hitNumber = hit;
-		else if (bm->strategy == RS_CLOCK)
-			newPage->hitNumber = 1;
-
-		page->pageNum = pageNum;
-		page->data = newPage->data;
-
-		// Page Replacement Strategy Execution
-		ReplacementStrategy strategy = bm->strategy;
-
-		if(strategy == RS_FIFO)
-			FIFO(bm, newPage);
-		else if(strategy == RS_LRU)
-			LRU(bm, newPage);
-		else if(strategy == RS_CLOCK)
-			CLOCK(bm, newPage);
-		else if(strategy == RS_LFU)
-			printf("\n LFU algorithm not implemented");
 		else
-			printf("\n Strategy not detected or Strategy not implemented\n");
+		{
+			frameIndex = reserveFrame(bm, partition, pageNums[iter], &loads[numLoads].evictedPageNum, NULL);
+			if (frameIndex == -1)
+			{
+				result = RC_PINNED_PAGES_IN_BUFFER;
+				continue;
+			}
+			addCount(&partition->stats.misses, 1);
+			loads[numLoads].partition = partition;
+			loads[numLoads].pageNum = pageNums[iter];
+			loads[numLoads].evictedData = pageFrame[frameIndex].data;
+			loadPages[numLoads++] = iter;
+		}
+	}
+	if (lockedPartition != NULL)
+		pthread_mutex_unlock(&lockedPartition->partitionLatch);
+
+	// Reading the misses, they stay pinned
+	loadReservedFrames(bm, loads, numLoads, true, false);
+	for (iter = 0; iter < numLoads; iter++)
+	{
+		if (loads[iter].result == RC_OK)
+		{
+			pages[loadPages[iter]].pageNum = loads[iter].pageNum;
+			pages[loadPages[iter]].data = loads[iter].data;
+		}
+		else if (result == RC_OK)
+			result = loads[iter].result;
+	}
+
+	// Pinning the pages that were being read or written back
+	for (iter = 0; iter < numWaiting && result == RC_OK; iter++)
+		result = pinPage(bm, &pages[waitingPages[iter]], pageNums[waitingPages[iter]]);
+
+	// Releasing the pages pinned so far if one of them could not be pinned
+	if (result != RC_OK)
+	{
+		unpinPages(bm, pages, numPages);
+		for (iter = 0; iter < numPages; iter++)
+		{
+			pages[iter].pageNum = NO_PAGE;
+			pages[iter].data = NULL;
+		}
+	}
+
+	free(waitingPages);
+	free(loadPages);
+	free(loads);
+	return result;
+}
+
+// unpinPages unpins the pages of the handles pages[0 .. numPages-1], with one latch acquisition per run of pages of the
+// same partition. It returns RC_ERROR if a page is not in the pool, the other pages are unpinned nevertheless.
+extern RC unpinPages(BM_BufferPool *const bm, BM_PageHandle *const pages, const int numPages)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PoolPartition *lockedPartition = NULL;
+	RC result = RC_OK;
+
+	int iter;
+	for (iter = 0; iter < numPages; iter++)
+	{
+		PoolPartition *partition = getPartition(poolInfo, pages[iter].pageNum);
+		if (partition != lockedPartition)
+		{
+			if (lockedPartition != NULL)
+				pthread_mutex_unlock(&lockedPartition->partitionLatch);
+			pthread_mutex_lock(&partition->partitionLatch);
+			lockedPartition = partition;
+		}
+
+		// Handles without a page are not in the page table either
+		int frameIndex = findFrame(partition, pages[iter].pageNum);
+		if (frameIndex == -1 || pages[iter].pageNum == NO_PAGE)
+		{
+			result = RC_ERROR;
+			continue;
+		}
+
+		// the replacement policy may evict the frame again once no client uses it anymore
+		unpinFrame(poolInfo, partition, frameIndex);
 	}
+	if (lockedPartition != NULL)
+		pthread_mutex_unlock(&lockedPartition->partitionLatch);
+	return result;
+}
+
+// latchPage takes the latch of a pinned page: shared to read the page, exclusive to modify it
+extern RC latchPage(BM_BufferPool *const bm, BM_PageHandle *const page, const bool exclusive)
+{
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	PoolPartition *partition = getPartition(poolInfo, page->pageNum);
+
+	// Pages of a zero-copy pool can only be read
+	if (exclusive && poolInfo->zeroCopy)
+		return RC_WRITE_FAILED;
+
+	// Looking the page up in the page table, the frame keeps the page as long as the client has it pinned
+	pthread_mutex_lock(&partition->partitionLatch);
+	int frameIndex = findFrame(partition, page->pageNum);
+	if (frameIndex == -1 || partition->pageFrames[frameIndex].clientCount == 0)
+	{
+		pthread_mutex_unlock(&partition->partitionLatch);
+		return RC_ERROR;
+	}
+	pthread_rwlock_t *latch = partition->pageFrames[frameIndex].latch;
+	pthread_mutex_unlock(&partition->partitionLatch);
+
+	if (exclusive)
+		pthread_rwlock_wrlock(latch);
+	else
+		pthread_rwlock_rdlock(latch);
+	return RC_OK;
+}
+
+// unlatchPage releases the latch taken by latchPage, before the page is unpinned
+extern RC unlatchPage(BM_BufferPool *const bm, BM_PageHandle *const page)
+{
+	PoolPartition *partition = getPartition((BufferPoolInfo *)bm->mgmtData, page->pageNum);
+
+	pthread_mutex_lock(&partition->partitionLatch);
+	int frameIndex = findFrame(partition, page->pageNum);
+	pthread_rwlock_t *latch = (frameIndex != -1) ? partition->pageFrames[frameIndex].latch : NULL;
+	pthread_mutex_unlock(&partition->partitionLatch);
+	if (frameIndex == -1)
+		return RC_ERROR;
+
+	pthread_rwlock_unlock(latch);
 	return RC_OK;
 }
 
@@ -469,73 +2598,154 @@ extern RC pinPage(BM_BufferPool *const bm, BM_PageHandle *const page,
 // getFrameContents function returns an array of page numbers.
 extern PageNumber *getFrameContents(BM_BufferPool *const bm)
 {
-	PageNumber *frameContents = malloc(sizeof(PageNumber) * bufferSize);
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-
-	int iter = 0;
-	// setting frameContents value for each page frame
-	while (iter < bufferSize)
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+
+	// All partition latches are held, so that a resize does not change the frames meanwhile
+	lockPartitions(poolInfo);
+	PageNumber *frameContents = malloc(sizeof(PageNumber) * bm->numPages);
+	int position = 0;
+	int partitionIndex;
+	// setting frameContents value for each page frame, one partition after the other
+	for (partitionIndex = 0; partitionIndex < poolInfo->numPartitions; partitionIndex++)
 	{
-		if (pageFrame[iter].pageNum != -1) {
-			frameContents[iter] = pageFrame[iter].pageNum;
-		}
-		else {
-			frameContents[iter] = NO_PAGE;
+		PoolPartition *partition = &poolInfo->partitions[partitionIndex];
+		PageFrame *pageFrame = partition->pageFrames;
+		int iter;
+		for (iter = 0; iter < partition->numFrames; iter++)
+		{
+			if (pageFrame[iter].pageNum != -1) {
+				frameContents[position++] = pageFrame[iter].pageNum;
+			}
+			else {
+				frameContents[position++] = NO_PAGE;
+			}
 		}
-		iter++;
 	}
+	unlockPartitions(poolInfo);
 	return frameContents;
 }
 
 // getDirtyFlags function returns an array of isPageDirty falg for each page.
 extern bool *getDirtyFlags(BM_BufferPool *const bm)
 {
-	bool *isPageDirtyFlags = malloc(sizeof(bool) * bufferSize);
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-
-	int iter;
-	// setting isPageDirty flag for each page
-	for (iter = 0; iter < bufferSize; iter++)
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+
+	// All partition latches are held, so that a resize does not change the frames meanwhile
+	lockPartitions(poolInfo);
+	bool *isPageDirtyFlags = malloc(sizeof(bool) * bm->numPages);
+	int position = 0;
+	int partitionIndex;
+	// setting isPageDirty flag for each page, one partition after the other
+	for (partitionIndex = 0; partitionIndex < poolInfo->numPartitions; partitionIndex++)
 	{
-		isPageDirtyFlags[iter] = false;
-		if (pageFrame[iter].isPageDirty == true)
+		PoolPartition *partition = &poolInfo->partitions[partitionIndex];
+		PageFrame *pageFrame = partition->pageFrames;
+		int iter;
+		for (iter = 0; iter < partition->numFrames; iter++)
 		{
-			isPageDirtyFlags[iter] = true;
+			isPageDirtyFlags[position] = false;
+			if (pageFrame[iter].isPageDirty == true)
+			{
+				isPageDirtyFlags[position] = true;
+			}
+			position++;
 		}
 	}
+	unlockPartitions(poolInfo);
 	return isPageDirtyFlags;
 }
 
 // getFixCounts function returns an array of the fix counts for each page frame.
 extern int *getFixCounts(BM_BufferPool *const bm)
 {
-	int *fixCounts = malloc(sizeof(int) * bufferSize);
-	PageFrame *pageFrame = (PageFrame *)bm->mgmtData;
-
-	int iter = 0;
-	while (iter < bufferSize)
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+
+	// All partition latches are held, so that a resize does not change the frames meanwhile
+	lockPartitions(poolInfo);
+	int *fixCounts = malloc(sizeof(int) * bm->numPages);
+	int position = 0;
+	int partitionIndex;
+	for (partitionIndex = 0; partitionIndex < poolInfo->numPartitions; partitionIndex++)
 	{
-		fixCounts[iter] = 0;
-		if (pageFrame[iter].clientCount != -1)
-		{
-			fixCounts[iter] = pageFrame[iter].clientCount;
-		}
-		iter++;
+		PoolPartition *partition = &poolInfo->partitions[partitionIndex];
+		int iter;
+		for (iter = 0; iter < partition->numFrames; iter++)
+			fixCounts[position++] = __atomic_load_n(&partition->pageFrames[iter].clientCount, __ATOMIC_ACQUIRE);
 	}
+	unlockPartitions(poolInfo);
 	return fixCounts;
 }
 
-// getNumReadIO function returns the number of pages that have been read from disk since a buffer pool has been initialized.
+// getNumReadIO function returns the number of pages that have been read from disk since a buffer pool has been initialized,
+// for pins and by prefetches.
 extern int getNumReadIO(BM_BufferPool *const bm)
 {
-	// numPagesReadCount starts with 0.
-	return (numPagesReadCount + 1);
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	long numReadIO = 0;
+
+	// Adding up the reads of all partitions, the counters are read without the partition latches
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+	{
+		numReadIO += __atomic_load_n(&poolInfo->partitions[iter].numPagesReadCount, __ATOMIC_RELAXED);
+		numReadIO += __atomic_load_n(&poolInfo->partitions[iter].stats.prefetchedPages, __ATOMIC_RELAXED);
+	}
+	return (int)numReadIO;
 }
 
 // getNumWriteIO function returns the number of pages written to the page file since the buffer pool has been initialized.
 extern int getNumWriteIO(BM_BufferPool *const bm)
 {
-	return totalDiskWriteCount;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	long numWriteIO = 0;
+
+	// Adding up the writes of all partitions, the counters are read without the partition latches
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+		numWriteIO += __atomic_load_n(&poolInfo->partitions[iter].totalDiskWriteCount, __ATOMIC_RELAXED);
+	return (int)numWriteIO;
+}
+
+// Adds a counter of a partition read with a relaxed atomic load to a total of getPoolStats
+static void sumCount(long *total, long *counter)
+{
+	*total += __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+// getPoolStats function fills stats with the statistics of all partitions of the pool, without allocating anything.
+// No latch is taken: every counter is exact on its own, but counters read while clients use the pool may be a few
+// events apart from each other.
+extern RC getPoolStats(BM_BufferPool *const bm, BM_PoolStats *const stats)
+{
+	if (bm->mgmtData == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+	BufferPoolInfo *poolInfo = (BufferPoolInfo *)bm->mgmtData;
+	memset(stats, 0, sizeof(BM_PoolStats));
+
+	// Adding up the counters of all partitions
+	int iter;
+	for (iter = 0; iter < poolInfo->numPartitions; iter++)
+	{
+		PoolPartition *partition = &poolInfo->partitions[iter];
+		sumCount(&stats->hits, &partition->stats.hits);
+		sumCount(&stats->misses, &partition->stats.misses);
+		sumCount(&stats->evictions, &partition->stats.evictions);
+		sumCount(&stats->dirtyWriteBacks, &partition->stats.dirtyWriteBacks);
+		sumCount(&stats->flushedPages, &partition->stats.flushedPages);
+		sumCount(&stats->prefetchedPages, &partition->stats.prefetchedPages);
+		sumCount(&stats->prefetchHits, &partition->stats.prefetchHits);
+		sumCount(&stats->pinWaits, &partition->stats.pinWaits);
+		sumCount(&stats->pinWaitMicros, &partition->stats.pinWaitMicros);
+		sumCount(&stats->numReadIO, &partition->numPagesReadCount);
+		sumCount(&stats->numWriteIO, &partition->totalDiskWriteCount);
+		int bucket;
+		for (bucket = 0; bucket < BM_LATENCY_BUCKETS; bucket++)
+		{
+			sumCount(&stats->readLatency[bucket], &partition->stats.readLatency[bucket]);
+			sumCount(&stats->writeLatency[bucket], &partition->stats.writeLatency[bucket]);
+		}
+	}
+	return RC_OK;
 }
 
-#pragma endregion
\ No newline at end of file
+#pragma endregion
@@ -13,7 +13,9 @@ typedef enum ReplacementStrategy {
   RS_LRU = 1,
   RS_CLOCK = 2,
   RS_LFU = 3,
-  RS_LRU_K = 4
+  RS_LRU_K = 4,
+  RS_2Q = 5,  // stratData may point to an int: share of the pool for pages used once, in percent (default 25)
+  RS_ARC = 6
 } ReplacementStrategy;
 
 // Data Types and Structures
@@ -23,6 +25,7 @@ typedef int PageNumber;
 typedef struct BM_BufferPool {
   char *pageFile;
   int numPages;
+  int pageSize; // size of the pages in bytes, taken from the page file
   ReplacementStrategy strategy;
   void *mgmtData; // use this one to store the bookkeeping info your buffer 
                   // manager needs for a buffer pool
@@ -33,6 +36,49 @@ typedef struct BM_PageHandle {
   char *data;
 } BM_PageHandle;
 
+// Optional settings of a buffer pool, see initBufferPoolWithOptions
+typedef struct BM_PoolOptions {
+  bool zeroCopy; // read-only pool, page handles point straight into a mapping of the page file
+  bool directIO; // page file opened with O_DIRECT, pages are cached only once (in the pool)
+  const struct BM_ReplacementPolicy *policy; // used instead of the strategy's built-in policy, see buffer_mgr_policy.h
+  int numPartitions; // frames split into this many partitions by page number, each with its own latch, page table and replacement state (0 or 1: one partition)
+  int cleanFramesPercent; // a background writer keeps this percentage of the frames of every partition clean and unpinned (0: no background writer)
+  int readAheadPages; // pages read ahead in the background once adjacent pages are pinned one after the other (0: no read-ahead)
+  const char *warmStartFile; // list of the pages in the pool, written by shutdownBufferPool and prefetched again at init (NULL: cold start)
+} BM_PoolOptions;
+
+// Number of buckets of the latency histograms of BM_PoolStats
+#define BM_LATENCY_BUCKETS 20
+
+// Statistics of a buffer pool since it was initialized, see getPoolStats. A pin that waited for the page to be read by
+// another client counts as a hit. Bucket i < BM_LATENCY_BUCKETS-1 of a latency histogram counts the transfers that
+// took less than 2^i microseconds (and at least 2^(i-1)), the last bucket the slower ones.
+typedef struct BM_PoolStats {
+  long hits; // pins of pages that were in the pool
+  long misses; // pins that had to read their page
+  long evictions; // pages replaced by another page
+  long dirtyWriteBacks; // evicted pages that were dirty and written back
+  long flushedPages; // dirty pages written by forcePage, forceFlushPool and the background writer
+  long prefetchedPages; // pages read by prefetches, read-ahead and warm starts, not counted in numReadIO
+  long prefetchHits; // prefetched pages that were pinned
+  long pinWaits; // pins that waited for a read or write-back of their page by another client
+  long pinWaitMicros; // time these pins waited, in microseconds
+  long numReadIO; // pages read for pins: getNumReadIO without the prefetched pages
+  long numWriteIO; // as getNumWriteIO
+  long readLatency[BM_LATENCY_BUCKETS]; // page reads by the time they took
+  long writeLatency[BM_LATENCY_BUCKETS]; // page writes by the time they took
+} BM_PoolStats;
+
+// Access strategy of a bulk operation (a scan or a bulk load), see pinPageWithStrategy. Once the operation loaded
+// pages into ringSize frames it recycles these frames instead of evicting the pages of other clients. A strategy
+// belongs to one operation and must not be shared between threads.
+typedef struct BM_AccessStrategy {
+  int ringSize;
+  int *ringFrames; // frames the operation loaded pages into (indexed within the page's partition), -1 for an empty slot
+  PageNumber *ringPages; // page loaded into each of these frames
+  int nextSlot; // oldest slot of the ring, recycled next
+} BM_AccessStrategy;
+
 // convenience macros
 #define MAKE_POOL()					\
   ((BM_BufferPool *) malloc (sizeof(BM_BufferPool)))
@@ -44,8 +90,13 @@ typedef struct BM_PageHandle {
 RC initBufferPool(BM_BufferPool *const bm, const char *const pageFileName, 
 		  const int numPages, ReplacementStrategy strategy, 
 		  void *stratData);
+RC initBufferPoolWithOptions(BM_BufferPool *const bm, const char *const pageFileName,
+		  const int numPages, ReplacementStrategy strategy,
+		  void *stratData, const BM_PoolOptions *const options);
 RC shutdownBufferPool(BM_BufferPool *const bm);
 RC forceFlushPool(BM_BufferPool *const bm);
+// Changes the number of frames to newNumPages while the pool is in use, a shrink only drops frames nobody has pinned
+RC resizeBufferPool(BM_BufferPool *const bm, const int newNumPages);
 
 // Buffer Manager Interface Access Pages
 RC markDirty (BM_BufferPool *const bm, BM_PageHandle *const page);
@@ -53,6 +104,24 @@ RC unpinPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC forcePage (BM_BufferPool *const bm, BM_PageHandle *const page);
 RC pinPage (BM_BufferPool *const bm, BM_PageHandle *const page, 
 	    const PageNumber pageNum);
+RC pinPageWithStrategy (BM_BufferPool *const bm, BM_PageHandle *const page,
+	    const PageNumber pageNum, BM_AccessStrategy *const access);
+RC initAccessStrategy (BM_AccessStrategy *const access, const int ringSize);
+RC freeAccessStrategy (BM_AccessStrategy *const access);
+// Batch variants of pinPage and unpinPage for operations on several pages, pages is an array of numPages handles
+RC pinPages (BM_BufferPool *const bm, BM_PageHandle *const pages,
+	    const PageNumber *const pageNums, const int numPages);
+RC unpinPages (BM_BufferPool *const bm, BM_PageHandle *const pages, const int numPages);
+// Hint that pages startPage .. startPage+count-1 will be pinned soon, they are read in the background
+RC prefetchPages (BM_BufferPool *const bm, const PageNumber startPage, const int count);
+RC prefetchPagesWithStrategy (BM_BufferPool *const bm, const PageNumber startPage, const int count,
+	    BM_AccessStrategy *const access);
+
+// Concurrent access: all functions except initBufferPool and shutdownBufferPool may be called by several
+// threads at once. A client reading a pinned page that others may modify holds its latch shared, a client
+// modifying it holds the latch exclusive. Latches are released before the page is unpinned.
+RC latchPage (BM_BufferPool *const bm, BM_PageHandle *const page, const bool exclusive);
+RC unlatchPage (BM_BufferPool *const bm, BM_PageHandle *const page);
 
 // Statistics Interface
 PageNumber *getFrameContents (BM_BufferPool *const bm);
@@ -60,5 +129,7 @@ bool *getDirtyFlags (BM_BufferPool *const bm);
 int *getFixCounts (BM_BufferPool *const bm);
 int getNumReadIO (BM_BufferPool *const bm);
 int getNumWriteIO (BM_BufferPool *const bm);
+// Fills the caller's stats with the statistics of the whole pool without allocating memory, cheap enough to be called often
+RC getPoolStats (BM_BufferPool *const bm, BM_PoolStats *const stats);
 
 #endif
@@ -0,0 +1,1116 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "buffer_mgr_policy.h"
+
+// Ends and length of a doubly linked list of frames or ghost entries, first is the most recently added one
+typedef struct ListHead
+{
+	int first;
+	int last;
+	int size;
+} ListHead;
+
+// ***** HELPER FUNCTIONS ***** //
+#pragma region HELPER FUNCTIONS
+
+// Bucket of a hash table with mask + 1 buckets that holds page pageNum
+static int hashPageNumber(const PageNumber pageNum, int mask)
+{
+	unsigned int hash = (unsigned int)pageNum * 2654435761u;
+	return (int)(hash & (unsigned int)mask);
+}
+
+// Number of buckets of a hash table for numEntries entries: a power of two, at least twice as many as entries
+static int hashTableSize(int numEntries)
+{
+	int bucketCount = 1;
+	while (bucketCount < 2 * numEntries)
+		bucketCount *= 2;
+	return bucketCount;
+}
+
+static void initList(ListHead *list)
+{
+	list->first = list->last = -1;
+	list->size = 0;
+}
+
+// Adds entry 'index' in front of a list whose links are kept in prev and next
+static void pushListEntry(ListHead *list, int *prev, int *next, int index)
+{
+	prev[index] = -1;
+	next[index] = list->first;
+	if (list->first != -1)
+		prev[list->first] = index;
+	else
+		list->last = index;
+	list->first = index;
+	list->size++;
+}
+
+// Takes entry 'index' out of a list whose links are kept in prev and next
+static void unlinkListEntry(ListHead *list, int *prev, int *next, int index)
+{
+	if (prev[index] != -1)
+		next[prev[index]] = next[index];
+	else
+		list->first = next[index];
+	if (next[index] != -1)
+		prev[next[index]] = prev[index];
+	else
+		list->last = prev[index];
+	prev[index] = next[index] = -1;
+	list->size--;
+}
+
+// Returns the frame of the list that was added the longest time ago and is not pinned, -1 if there is none
+static int findUnpinnedFrame(BM_BufferPool *const bm, ListHead *list, int *prev)
+{
+	int frameIndex = list->last;
+	while (frameIndex != -1 && getFrameFixCount(bm, frameIndex) != 0)
+		frameIndex = prev[frameIndex];
+	return frameIndex;
+}
+
+#pragma endregion
+
+// ***** FIFO AND LRU ***** //
+#pragma region FIFO AND LRU
+
+// FIFO and LRU keep the frames in one list, the frame at the end is replaced. FIFO adds frames when they are
+// loaded, LRU also moves them to the front when they are used again.
+typedef struct QueueState
+{
+	ListHead queue;
+	int *framePrev;
+	int *frameNext;
+} QueueState;
+
+static RC queueInit(void **policyData, int numFrames, void *stratData)
+{
+	QueueState *state = malloc(sizeof(QueueState));
+	initList(&state->queue);
+	state->framePrev = malloc(sizeof(int) * numFrames);
+	state->frameNext = malloc(sizeof(int) * numFrames);
+
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+		state->framePrev[iter] = state->frameNext[iter] = -1;
+	*policyData = state;
+	return RC_OK;
+}
+
+static RC queueInitFrom(void *policyData, void **newPolicyData, int numFrames)
+{
+	return queueInit(newPolicyData, numFrames, NULL);
+}
+
+static void queueShutdown(void *policyData)
+{
+	QueueState *state = (QueueState *)policyData;
+	free(state->framePrev);
+	free(state->frameNext);
+	free(state);
+}
+
+static void queueOnLoad(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	QueueState *state = (QueueState *)policyData;
+	pushListEntry(&state->queue, state->framePrev, state->frameNext, frameIndex);
+}
+
+// Moves the frame to the front of the list, LRU only
+static void queueOnHit(void *policyData, int frameIndex)
+{
+	QueueState *state = (QueueState *)policyData;
+	if (state->queue.first == frameIndex)
+		return;
+	unlinkListEntry(&state->queue, state->framePrev, state->frameNext, frameIndex);
+	pushListEntry(&state->queue, state->framePrev, state->frameNext, frameIndex);
+}
+
+static int queuePickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	QueueState *state = (QueueState *)policyData;
+	return findUnpinnedFrame(bm, &state->queue, state->framePrev);
+}
+
+static void queueOnEvict(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	QueueState *state = (QueueState *)policyData;
+	unlinkListEntry(&state->queue, state->framePrev, state->frameNext, frameIndex);
+}
+
+// The frames that stay keep their order in the list
+static void queueResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	QueueState *state = (QueueState *)policyData;
+	QueueState *newState = (QueueState *)newPolicyData;
+	int frameIndex;
+	for (frameIndex = state->queue.last; frameIndex != -1; frameIndex = state->framePrev[frameIndex])
+		if (frameMap[frameIndex] != -1)
+			pushListEntry(&newState->queue, newState->framePrev, newState->frameNext, frameMap[frameIndex]);
+}
+
+#pragma endregion
+
+// ***** CLOCK ***** //
+#pragma region CLOCK
+
+// CLOCK gives every frame a reference bit, set whenever the page is used. The clock hand passes over the frames
+// and clears the bits until it finds a frame whose bit is already clear.
+typedef struct ClockState
+{
+	int numFrames;
+	int clockHand;
+	bool *referenced;
+} ClockState;
+
+static RC clockInit(void **policyData, int numFrames, void *stratData)
+{
+	ClockState *state = malloc(sizeof(ClockState));
+	state->numFrames = numFrames;
+	state->clockHand = 0;
+	state->referenced = calloc(numFrames, sizeof(bool));
+	*policyData = state;
+	return RC_OK;
+}
+
+static RC clockInitFrom(void *policyData, void **newPolicyData, int numFrames)
+{
+	return clockInit(newPolicyData, numFrames, NULL);
+}
+
+static void clockShutdown(void *policyData)
+{
+	ClockState *state = (ClockState *)policyData;
+	free(state->referenced);
+	free(state);
+}
+
+static void clockOnLoad(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	((ClockState *)policyData)->referenced[frameIndex] = true;
+}
+
+static void clockOnHit(void *policyData, int frameIndex)
+{
+	((ClockState *)policyData)->referenced[frameIndex] = true;
+}
+
+static int clockPickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	ClockState *state = (ClockState *)policyData;
+
+	// Two rounds clear every bit, a frame that is not pinned is found by then if there is one
+	int step;
+	for (step = 0; step <= 2 * state->numFrames; step++)
+	{
+		int frameIndex = state->clockHand;
+		state->clockHand = (state->clockHand + 1) % state->numFrames;
+		if (getFrameFixCount(bm, frameIndex) != 0)
+			continue;
+		if (!state->referenced[frameIndex])
+			return frameIndex;
+		state->referenced[frameIndex] = false;
+	}
+	return -1;
+}
+
+// The frames that stay keep their reference bits, the hand stays at the first frame it had not passed yet
+static void clockResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	ClockState *state = (ClockState *)policyData;
+	ClockState *newState = (ClockState *)newPolicyData;
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+		if (frameMap[iter] != -1)
+			newState->referenced[frameMap[iter]] = state->referenced[iter];
+	for (iter = state->clockHand; iter < numFrames; iter++)
+	{
+		if (frameMap[iter] != -1)
+		{
+			newState->clockHand = frameMap[iter];
+			break;
+		}
+	}
+}
+
+#pragma endregion
+
+// ***** LFU ***** //
+#pragma region LFU
+
+// A group of frames whose pages were used equally often. The buckets form a list ordered by frequency,
+// every bucket keeps its frames in a list with the most recently used frame first.
+typedef struct FrequencyBucket
+{
+	int frequency;
+	int prevBucket;
+	int nextBucket;
+	ListHead frames;
+} FrequencyBucket;
+
+typedef struct LFUState
+{
+	// one bucket per frame is enough, the unused buckets are chained through nextBucket starting at freeBucket
+	FrequencyBucket *buckets;
+	int lowestBucket;
+	int freeBucket;
+	// per frame: its bucket (-1 for an empty frame) and its neighbours in the bucket
+	int *frameBucket;
+	int *framePrev;
+	int *frameNext;
+} LFUState;
+
+static RC lfuInit(void **policyData, int numFrames, void *stratData)
+{
+	LFUState *lfu = malloc(sizeof(LFUState));
+	lfu->buckets = malloc(sizeof(FrequencyBucket) * numFrames);
+	lfu->frameBucket = malloc(sizeof(int) * numFrames);
+	lfu->framePrev = malloc(sizeof(int) * numFrames);
+	lfu->frameNext = malloc(sizeof(int) * numFrames);
+	lfu->lowestBucket = -1;
+	lfu->freeBucket = 0;
+
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+	{
+		lfu->buckets[iter].nextBucket = (iter + 1 < numFrames) ? iter + 1 : -1;
+		lfu->frameBucket[iter] = lfu->framePrev[iter] = lfu->frameNext[iter] = -1;
+	}
+	*policyData = lfu;
+	return RC_OK;
+}
+
+static RC lfuInitFrom(void *policyData, void **newPolicyData, int numFrames)
+{
+	return lfuInit(newPolicyData, numFrames, NULL);
+}
+
+static void lfuShutdown(void *policyData)
+{
+	LFUState *lfu = (LFUState *)policyData;
+	free(lfu->buckets);
+	free(lfu->frameBucket);
+	free(lfu->framePrev);
+	free(lfu->frameNext);
+	free(lfu);
+}
+
+// Takes a bucket from the free list and links it into the bucket list after bucket 'after' (-1 for the front)
+static int newFrequencyBucket(LFUState *lfu, int frequency, int after)
+{
+	int bucket = lfu->freeBucket;
+	FrequencyBucket *buckets = lfu->buckets;
+	lfu->freeBucket = buckets[bucket].nextBucket;
+
+	buckets[bucket].frequency = frequency;
+	initList(&buckets[bucket].frames);
+	buckets[bucket].prevBucket = after;
+	buckets[bucket].nextBucket = (after == -1) ? lfu->lowestBucket : buckets[after].nextBucket;
+	if (buckets[bucket].nextBucket != -1)
+		buckets[buckets[bucket].nextBucket].prevBucket = bucket;
+	if (after == -1)
+		lfu->lowestBucket = bucket;
+	else
+		buckets[after].nextBucket = bucket;
+	return bucket;
+}
+
+// Takes the frame out of its bucket. A bucket that becomes empty is returned to the free list.
+// Returns the bucket in front of the frame's bucket that is still linked (-1 if there is none).
+static int unlinkFrameFromBucket(LFUState *lfu, int frameIndex)
+{
+	int bucket = lfu->frameBucket[frameIndex];
+	FrequencyBucket *buckets = lfu->buckets;
+
+	unlinkListEntry(&buckets[bucket].frames, lfu->framePrev, lfu->frameNext, frameIndex);
+	lfu->frameBucket[frameIndex] = -1;
+	if (buckets[bucket].frames.size > 0)
+		return bucket;
+
+	// Removing the empty bucket from the bucket list
+	int prevBucket = buckets[bucket].prevBucket;
+	if (prevBucket != -1)
+		buckets[prevBucket].nextBucket = buckets[bucket].nextBucket;
+	else
+		lfu->lowestBucket = buckets[bucket].nextBucket;
+	if (buckets[bucket].nextBucket != -1)
+		buckets[buckets[bucket].nextBucket].prevBucket = prevBucket;
+	buckets[bucket].nextBucket = lfu->freeBucket;
+	lfu->freeBucket = bucket;
+	return prevBucket;
+}
+
+static void linkFrameToBucket(LFUState *lfu, int frameIndex, int bucket)
+{
+	lfu->frameBucket[frameIndex] = bucket;
+	pushListEntry(&lfu->buckets[bucket].frames, lfu->framePrev, lfu->frameNext, frameIndex);
+}
+
+// A new page starts with a frequency of 1
+static void lfuOnLoad(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	LFUState *lfu = (LFUState *)policyData;
+	int bucket = lfu->lowestBucket;
+	if (bucket == -1 || lfu->buckets[bucket].frequency != 1)
+		bucket = newFrequencyBucket(lfu, 1, -1);
+	linkFrameToBucket(lfu, frameIndex, bucket);
+}
+
+// The frame moves to the bucket of the next higher frequency
+static void lfuOnHit(void *policyData, int frameIndex)
+{
+	LFUState *lfu = (LFUState *)policyData;
+	int bucket = lfu->frameBucket[frameIndex];
+	int frequency = lfu->buckets[bucket].frequency + 1;
+	int nextBucket = lfu->buckets[bucket].nextBucket;
+
+	int prevBucket = unlinkFrameFromBucket(lfu, frameIndex);
+	if (nextBucket == -1 || lfu->buckets[nextBucket].frequency != frequency)
+		nextBucket = newFrequencyBucket(lfu, frequency, prevBucket);
+	linkFrameToBucket(lfu, frameIndex, nextBucket);
+}
+
+// Searching the buckets from the lowest frequency on, within a bucket from the least recently used frame on
+static int lfuPickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	LFUState *lfu = (LFUState *)policyData;
+	int bucket;
+	for (bucket = lfu->lowestBucket; bucket != -1; bucket = lfu->buckets[bucket].nextBucket)
+	{
+		int frameIndex = findUnpinnedFrame(bm, &lfu->buckets[bucket].frames, lfu->framePrev);
+		if (frameIndex != -1)
+			return frameIndex;
+	}
+	return -1;
+}
+
+static void lfuOnEvict(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	unlinkFrameFromBucket((LFUState *)policyData, frameIndex);
+}
+
+// The frames that stay keep their frequency and their order within their bucket
+static void lfuResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	LFUState *lfu = (LFUState *)policyData;
+	LFUState *newLfu = (LFUState *)newPolicyData;
+	int lastBucket = -1;
+	int bucket;
+	for (bucket = lfu->lowestBucket; bucket != -1; bucket = lfu->buckets[bucket].nextBucket)
+	{
+		int newBucket = -1;
+		int frameIndex;
+		for (frameIndex = lfu->buckets[bucket].frames.last; frameIndex != -1; frameIndex = lfu->framePrev[frameIndex])
+		{
+			if (frameMap[frameIndex] == -1)
+				continue;
+			if (newBucket == -1)
+				newBucket = lastBucket = newFrequencyBucket(newLfu, lfu->buckets[bucket].frequency, lastBucket);
+			linkFrameToBucket(newLfu, frameMap[frameIndex], newBucket);
+		}
+	}
+}
+
+#pragma endregion
+
+// ***** LRU-K ***** //
+#pragma region LRU-K
+
+typedef struct LRUKState
+{
+	int k;
+	// logical clock, advanced on every reference
+	uint64_t clock;
+	// per frame: the times of the last k references, most recent first, 0 for references that did not happen
+	uint64_t *frameHistory;
+	// heap of the frames that are not pinned, the frame with the oldest k-th reference on top.
+	// heapPosition is -1 for frames that are not in the heap.
+	int *heap;
+	int heapSize;
+	int *heapPosition;
+	// reference history of recently evicted pages: a ring of one entry per frame, indexed by a hash table on
+	// the page number whose chains are linked through retainedNext
+	PageNumber *retainedPages;
+	uint64_t *retainedHistory;
+	int *retainedNext;
+	int *retainedTable;
+	int retainedMask;
+	int retainedCursor;
+	int retainedSlots;
+} LRUKState;
+
+// k is taken from stratData, 1 if it is NULL
+static RC lruKInit(void **policyData, int numFrames, void *stratData)
+{
+	int k = (stratData != NULL) ? *(int *)stratData : 1;
+	if (k < 1)
+		return RC_ERROR;
+
+	LRUKState *lruK = malloc(sizeof(LRUKState));
+	lruK->k = k;
+	lruK->clock = 0;
+	lruK->frameHistory = calloc((size_t)numFrames * k, sizeof(uint64_t));
+	lruK->heap = malloc(sizeof(int) * numFrames);
+	lruK->heapSize = 0;
+	lruK->heapPosition = malloc(sizeof(int) * numFrames);
+	lruK->retainedPages = malloc(sizeof(PageNumber) * numFrames);
+	lruK->retainedHistory = malloc(sizeof(uint64_t) * numFrames * k);
+	lruK->retainedNext = malloc(sizeof(int) * numFrames);
+	lruK->retainedCursor = 0;
+	lruK->retainedSlots = numFrames;
+
+	int bucketCount = hashTableSize(numFrames);
+	lruK->retainedTable = malloc(sizeof(int) * bucketCount);
+	lruK->retainedMask = bucketCount - 1;
+
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+	{
+		lruK->heapPosition[iter] = -1;
+		lruK->retainedPages[iter] = NO_PAGE;
+		lruK->retainedNext[iter] = -1;
+	}
+	for (iter = 0; iter < bucketCount; iter++)
+		lruK->retainedTable[iter] = -1;
+	*policyData = lruK;
+	return RC_OK;
+}
+
+// The new state keeps K
+static RC lruKInitFrom(void *policyData, void **newPolicyData, int numFrames)
+{
+	return lruKInit(newPolicyData, numFrames, &((LRUKState *)policyData)->k);
+}
+
+static void lruKShutdown(void *policyData)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	free(lruK->frameHistory);
+	free(lruK->heap);
+	free(lruK->heapPosition);
+	free(lruK->retainedPages);
+	free(lruK->retainedHistory);
+	free(lruK->retainedNext);
+	free(lruK->retainedTable);
+	free(lruK);
+}
+
+// True if frame 'first' is to be evicted before frame 'second': its k-th most recent reference is older
+// (frames with fewer than k references come first), ties are decided by the most recent reference
+static bool lruKEvictsBefore(LRUKState *lruK, int first, int second)
+{
+	uint64_t *firstHistory = &lruK->frameHistory[(size_t)first * lruK->k];
+	uint64_t *secondHistory = &lruK->frameHistory[(size_t)second * lruK->k];
+	if (firstHistory[lruK->k - 1] != secondHistory[lruK->k - 1])
+		return firstHistory[lruK->k - 1] < secondHistory[lruK->k - 1];
+	return firstHistory[0] < secondHistory[0];
+}
+
+// Moves the heap entry at position 'position' to its place in the heap
+static void lruKSiftHeap(LRUKState *lruK, int position)
+{
+	int *heap = lruK->heap;
+	int frameIndex = heap[position];
+
+	// Upwards while the frame is evicted before its parent
+	while (position > 0 && lruKEvictsBefore(lruK, frameIndex, heap[(position - 1) / 2]))
+	{
+		heap[position] = heap[(position - 1) / 2];
+		lruK->heapPosition[heap[position]] = position;
+		position = (position - 1) / 2;
+	}
+
+	// Downwards while a child is evicted before the frame
+	while (2 * position + 1 < lruK->heapSize)
+	{
+		int child = 2 * position + 1;
+		if (child + 1 < lruK->heapSize && lruKEvictsBefore(lruK, heap[child + 1], heap[child]))
+			child++;
+		if (!lruKEvictsBefore(lruK, heap[child], frameIndex))
+			break;
+		heap[position] = heap[child];
+		lruK->heapPosition[heap[position]] = position;
+		position = child;
+	}
+	heap[position] = frameIndex;
+	lruK->heapPosition[frameIndex] = position;
+}
+
+// Takes a frame out of the heap of eviction candidates
+static void lruKHeapRemove(LRUKState *lruK, int frameIndex)
+{
+	int position = lruK->heapPosition[frameIndex];
+	if (position == -1)
+		return;
+	lruK->heapPosition[frameIndex] = -1;
+	lruK->heapSize--;
+	if (position == lruK->heapSize)
+		return;
+	lruK->heap[position] = lruK->heap[lruK->heapSize];
+	lruKSiftHeap(lruK, position);
+}
+
+// Records a reference to the page of the frame
+static void lruKReference(LRUKState *lruK, int frameIndex)
+{
+	uint64_t *history = &lruK->frameHistory[(size_t)frameIndex * lruK->k];
+	memmove(history + 1, history, sizeof(uint64_t) * (lruK->k - 1));
+	history[0] = ++lruK->clock;
+}
+
+// Removes the retained history entry 'slot' from the hash table of retained pages
+static void lruKForgetRetained(LRUKState *lruK, int slot)
+{
+	int *link = &lruK->retainedTable[hashPageNumber(lruK->retainedPages[slot], lruK->retainedMask)];
+	while (*link != -1 && *link != slot)
+		link = &lruK->retainedNext[*link];
+	if (*link == slot)
+		*link = lruK->retainedNext[slot];
+	lruK->retainedPages[slot] = NO_PAGE;
+}
+
+// Keeps the reference history of an evicted page in the ring of retained histories, replacing the oldest entry
+static void lruKRetain(LRUKState *lruK, PageNumber pageNum, const uint64_t *history)
+{
+	int slot = lruK->retainedCursor;
+	if (lruK->retainedPages[slot] != NO_PAGE)
+		lruKForgetRetained(lruK, slot);
+
+	lruK->retainedPages[slot] = pageNum;
+	memcpy(&lruK->retainedHistory[(size_t)slot * lruK->k], history, sizeof(uint64_t) * lruK->k);
+	int bucket = hashPageNumber(pageNum, lruK->retainedMask);
+	lruK->retainedNext[slot] = lruK->retainedTable[bucket];
+	lruK->retainedTable[bucket] = slot;
+
+	lruK->retainedCursor = (slot + 1) % lruK->retainedSlots;
+}
+
+// The history of the page is restored if the page was evicted recently, then the load counts as a reference
+static void lruKOnLoad(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	uint64_t *history = &lruK->frameHistory[(size_t)frameIndex * lruK->k];
+	int slot = lruK->retainedTable[hashPageNumber(pageNum, lruK->retainedMask)];
+	while (slot != -1 && lruK->retainedPages[slot] != pageNum)
+		slot = lruK->retainedNext[slot];
+
+	if (slot != -1)
+	{
+		memcpy(history, &lruK->retainedHistory[(size_t)slot * lruK->k], sizeof(uint64_t) * lruK->k);
+		lruKForgetRetained(lruK, slot);
+	}
+	else
+		memset(history, 0, sizeof(uint64_t) * lruK->k);
+	lruKReference(lruK, frameIndex);
+}
+
+// A pinned frame is no candidate for eviction
+static void lruKOnHit(void *policyData, int frameIndex)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	lruKHeapRemove(lruK, frameIndex);
+	lruKReference(lruK, frameIndex);
+}
+
+// The frame may be evicted again once no client uses it anymore
+static void lruKOnUnpin(void *policyData, int frameIndex)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	if (lruK->heapPosition[frameIndex] != -1)
+		return;
+	lruK->heap[lruK->heapSize] = frameIndex;
+	lruK->heapPosition[frameIndex] = lruK->heapSize;
+	lruK->heapSize++;
+	lruKSiftHeap(lruK, lruK->heapSize - 1);
+}
+
+// The heap only holds frames that are not pinned, its top has the oldest k-th most recent reference
+static int lruKPickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+
+	// Frames pinned without a hit (while forcePage or forceFlushPool writes them) leave the heap here, onUnpin adds them again
+	while (lruK->heapSize > 0 && getFrameFixCount(bm, lruK->heap[0]) != 0)
+		lruKHeapRemove(lruK, lruK->heap[0]);
+	return (lruK->heapSize > 0) ? lruK->heap[0] : -1;
+}
+
+// The history of the evicted page is retained, so that it is restored if the page is loaded again soon
+static void lruKOnEvict(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	lruKHeapRemove(lruK, frameIndex);
+
+	lruKRetain(lruK, pageNum, &lruK->frameHistory[(size_t)frameIndex * lruK->k]);
+}
+
+// The frames that stay keep their history and stay candidates for eviction if they were. The newest retained
+// histories are kept, as many as the new ring holds.
+static void lruKResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	LRUKState *lruK = (LRUKState *)policyData;
+	LRUKState *newLruK = (LRUKState *)newPolicyData;
+	newLruK->clock = lruK->clock;
+
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+		if (frameMap[iter] != -1)
+			memcpy(&newLruK->frameHistory[(size_t)frameMap[iter] * lruK->k], &lruK->frameHistory[(size_t)iter * lruK->k], sizeof(uint64_t) * lruK->k);
+	for (iter = 0; iter < lruK->heapSize; iter++)
+		if (frameMap[lruK->heap[iter]] != -1)
+			lruKOnUnpin(newLruK, frameMap[lruK->heap[iter]]);
+
+	// The ring is passed from its oldest entry at the cursor on
+	int numRetained = 0;
+	for (iter = 0; iter < lruK->retainedSlots; iter++)
+		if (lruK->retainedPages[iter] != NO_PAGE)
+			numRetained++;
+	int numSkipped = numRetained - newLruK->retainedSlots;
+	for (iter = 0; iter < lruK->retainedSlots; iter++)
+	{
+		int slot = (lruK->retainedCursor + iter) % lruK->retainedSlots;
+		if (lruK->retainedPages[slot] != NO_PAGE && numSkipped-- <= 0)
+			lruKRetain(newLruK, lruK->retainedPages[slot], &lruK->retainedHistory[(size_t)slot * lruK->k]);
+	}
+}
+
+#pragma endregion
+
+// ***** 2Q AND ARC ***** //
+#pragma region 2Q AND ARC
+
+// The two lists of 2Q and ARC: pages used once (A1in / T1) and pages used again (Am / T2)
+#define RECENT_LIST 0
+#define FREQUENT_LIST 1
+
+// State of the 2Q and ARC policies. The resident frames are in one of two lists. Ghost entries remember the
+// page numbers of recently evicted pages (A1out for 2Q, B1 and B2 for ARC), they are found through a hash table.
+typedef struct ScanResistantState
+{
+	int capacity;
+	// per frame: its list (-1 for an empty frame) and its neighbours in it
+	int *frameList;
+	int *framePrev;
+	int *frameNext;
+	ListHead resident[2];
+	// ghost entries, one per frame, the unused ones are chained through ghostNext starting at freeGhost
+	PageNumber *ghostPage;
+	int *ghostList;
+	int *ghostPrev;
+	int *ghostNext;
+	int *ghostHashNext;
+	int *ghostTable;
+	int ghostMask;
+	int freeGhost;
+	ListHead ghost[2];
+	// ghost entry of the page being loaded, found by pickVictim (-1 if none)
+	int incomingGhost;
+	// the next onLoad is for a page that was found in a ghost list
+	bool incomingFrequent;
+	// 2Q: share of the pool for A1in in percent, maximum length of A1in and A1out
+	int recentPercent;
+	int recentLimit;
+	int ghostLimit;
+	// ARC: target length of T1, adapted on every hit in a ghost list, and the value pickVictim computed
+	int recentTarget;
+	int nextTarget;
+} ScanResistantState;
+
+static RC initScanResistantState(void **policyData, int numFrames, int recentPercent)
+{
+	if (recentPercent < 1 || recentPercent > 100)
+		return RC_ERROR;
+
+	ScanResistantState *state = malloc(sizeof(ScanResistantState));
+	state->capacity = numFrames;
+	state->frameList = malloc(sizeof(int) * numFrames);
+	state->framePrev = malloc(sizeof(int) * numFrames);
+	state->frameNext = malloc(sizeof(int) * numFrames);
+	state->ghostPage = malloc(sizeof(PageNumber) * numFrames);
+	state->ghostList = malloc(sizeof(int) * numFrames);
+	state->ghostPrev = malloc(sizeof(int) * numFrames);
+	state->ghostNext = malloc(sizeof(int) * numFrames);
+	state->ghostHashNext = malloc(sizeof(int) * numFrames);
+	state->freeGhost = 0;
+	state->incomingGhost = -1;
+	state->incomingFrequent = false;
+	state->recentPercent = recentPercent;
+	state->recentLimit = numFrames * recentPercent / 100;
+	if (state->recentLimit < 1)
+		state->recentLimit = 1;
+	state->ghostLimit = (numFrames + 1) / 2;
+	state->recentTarget = state->nextTarget = 0;
+
+	int list;
+	for (list = 0; list < 2; list++)
+	{
+		initList(&state->resident[list]);
+		initList(&state->ghost[list]);
+	}
+
+	int bucketCount = hashTableSize(numFrames);
+	state->ghostTable = malloc(sizeof(int) * bucketCount);
+	state->ghostMask = bucketCount - 1;
+
+	int iter;
+	for (iter = 0; iter < numFrames; iter++)
+	{
+		state->frameList[iter] = state->framePrev[iter] = state->frameNext[iter] = -1;
+		state->ghostPage[iter] = NO_PAGE;
+		state->ghostList[iter] = state->ghostPrev[iter] = state->ghostHashNext[iter] = -1;
+		state->ghostNext[iter] = (iter + 1 < numFrames) ? iter + 1 : -1;
+	}
+	for (iter = 0; iter < bucketCount; iter++)
+		state->ghostTable[iter] = -1;
+	*policyData = state;
+	return RC_OK;
+}
+
+// 2Q keeps a quarter of the pool for pages used once unless stratData points to another percentage
+static RC twoQInit(void **policyData, int numFrames, void *stratData)
+{
+	return initScanResistantState(policyData, numFrames, (stratData != NULL) ? *(int *)stratData : 25);
+}
+
+static RC arcInit(void **policyData, int numFrames, void *stratData)
+{
+	return initScanResistantState(policyData, numFrames, 25);
+}
+
+// The new state keeps the share of A1in (ARC does not use it)
+static RC scanResistantInitFrom(void *policyData, void **newPolicyData, int numFrames)
+{
+	return initScanResistantState(newPolicyData, numFrames, ((ScanResistantState *)policyData)->recentPercent);
+}
+
+static void scanResistantShutdown(void *policyData)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	free(state->frameList);
+	free(state->framePrev);
+	free(state->frameNext);
+	free(state->ghostPage);
+	free(state->ghostList);
+	free(state->ghostPrev);
+	free(state->ghostNext);
+	free(state->ghostHashNext);
+	free(state->ghostTable);
+	free(state);
+}
+
+// Returns the ghost entry of page pageNum, -1 if the page was not evicted recently
+static int findGhost(ScanResistantState *state, const PageNumber pageNum)
+{
+	int ghost = state->ghostTable[hashPageNumber(pageNum, state->ghostMask)];
+	while (ghost != -1 && state->ghostPage[ghost] != pageNum)
+		ghost = state->ghostHashNext[ghost];
+	return ghost;
+}
+
+// Removes a ghost entry from its list and the hash table and returns it to the free list
+static void removeGhost(ScanResistantState *state, int ghost)
+{
+	int *link = &state->ghostTable[hashPageNumber(state->ghostPage[ghost], state->ghostMask)];
+	while (*link != -1 && *link != ghost)
+		link = &state->ghostHashNext[*link];
+	if (*link == ghost)
+		*link = state->ghostHashNext[ghost];
+
+	unlinkListEntry(&state->ghost[state->ghostList[ghost]], state->ghostPrev, state->ghostNext, ghost);
+	state->ghostPage[ghost] = NO_PAGE;
+	state->ghostList[ghost] = -1;
+	state->ghostNext[ghost] = state->freeGhost;
+	state->freeGhost = ghost;
+}
+
+// Remembers page pageNum in ghost list 'list'. If every entry is used the oldest entry of the longer list is dropped.
+static void addGhost(ScanResistantState *state, int list, const PageNumber pageNum)
+{
+	if (state->freeGhost == -1)
+		removeGhost(state, state->ghost[state->ghost[0].size >= state->ghost[1].size ? 0 : 1].last);
+
+	int ghost = state->freeGhost;
+	state->freeGhost = state->ghostNext[ghost];
+	state->ghostPage[ghost] = pageNum;
+	state->ghostList[ghost] = list;
+	pushListEntry(&state->ghost[list], state->ghostPrev, state->ghostNext, ghost);
+
+	int bucket = hashPageNumber(pageNum, state->ghostMask);
+	state->ghostHashNext[ghost] = state->ghostTable[bucket];
+	state->ghostTable[bucket] = ghost;
+}
+
+// Moves a frame to the front of resident list 'list'
+static void moveFrameToList(ScanResistantState *state, int frameIndex, int list)
+{
+	if (state->frameList[frameIndex] != -1)
+		unlinkListEntry(&state->resident[state->frameList[frameIndex]], state->framePrev, state->frameNext, frameIndex);
+	state->frameList[frameIndex] = list;
+	pushListEntry(&state->resident[list], state->framePrev, state->frameNext, frameIndex);
+}
+
+// Pages that were evicted recently go to the list of pages used again, others to the list of pages used once
+static void scanResistantOnLoad(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	bool frequent = state->incomingFrequent;
+	state->incomingFrequent = false;
+
+	// Pages loaded into empty frames did not pass pickVictim
+	int ghost = frequent ? -1 : findGhost(state, pageNum);
+	if (ghost != -1)
+	{
+		removeGhost(state, ghost);
+		frequent = true;
+	}
+	moveFrameToList(state, frameIndex, frequent ? FREQUENT_LIST : RECENT_LIST);
+}
+
+// 2Q leaves pages in A1in until they are evicted, only pages in Am move to the front
+static void twoQOnHit(void *policyData, int frameIndex)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	if (state->frameList[frameIndex] == FREQUENT_LIST)
+		moveFrameToList(state, frameIndex, FREQUENT_LIST);
+}
+
+// ARC moves every page that is used again to the front of T2
+static void arcOnHit(void *policyData, int frameIndex)
+{
+	moveFrameToList((ScanResistantState *)policyData, frameIndex, FREQUENT_LIST);
+}
+
+// Returns the victim of the preferred list, of the other list if all frames of the preferred list are pinned
+static int pickFromLists(ScanResistantState *state, BM_BufferPool *const bm, int list)
+{
+	int victimIndex = findUnpinnedFrame(bm, &state->resident[list], state->framePrev);
+	if (victimIndex == -1)
+		victimIndex = findUnpinnedFrame(bm, &state->resident[1 - list], state->framePrev);
+	return victimIndex;
+}
+
+// Pages used once are evicted first once A1in is longer than its share of the pool, the least recently
+// used page of Am otherwise
+static int twoQPickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	state->incomingGhost = findGhost(state, pageNum);
+	int victimIndex = pickFromLists(state, bm, (state->resident[RECENT_LIST].size > state->recentLimit) ? RECENT_LIST : FREQUENT_LIST);
+	if (victimIndex == -1)
+		state->incomingGhost = -1;
+	return victimIndex;
+}
+
+static void twoQOnEvict(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+
+	// A page found in A1out was used again shortly after its eviction, it goes to Am.
+	// Its entry is removed first, so that it cannot be the one dropped for the victim below.
+	if (state->incomingGhost != -1)
+	{
+		removeGhost(state, state->incomingGhost);
+		state->incomingGhost = -1;
+		state->incomingFrequent = true;
+	}
+
+	// Pages evicted from A1in are remembered in A1out, which is a FIFO queue of limited length
+	if (state->frameList[frameIndex] == RECENT_LIST)
+	{
+		if (state->ghost[RECENT_LIST].size >= state->ghostLimit)
+			removeGhost(state, state->ghost[RECENT_LIST].last);
+		addGhost(state, RECENT_LIST, pageNum);
+	}
+	unlinkListEntry(&state->resident[state->frameList[frameIndex]], state->framePrev, state->frameNext, frameIndex);
+	state->frameList[frameIndex] = -1;
+}
+
+// T1 gives up a page if it is longer than its target, T2 otherwise. A hit in a ghost list shifts the target length
+// of T1 first: towards T1 for a page from B1, towards T2 for a page from B2.
+static int arcPickVictim(void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	ListHead *resident = state->resident;
+	ListHead *ghost = state->ghost;
+
+	state->incomingGhost = findGhost(state, pageNum);
+	int ghostList = (state->incomingGhost != -1) ? state->ghostList[state->incomingGhost] : -1;
+	int target = state->recentTarget;
+	if (ghostList == RECENT_LIST)
+	{
+		int delta = (ghost[FREQUENT_LIST].size > ghost[RECENT_LIST].size) ? ghost[FREQUENT_LIST].size / ghost[RECENT_LIST].size : 1;
+		target = (target + delta < state->capacity) ? target + delta : state->capacity;
+	}
+	else if (ghostList == FREQUENT_LIST)
+	{
+		int delta = (ghost[RECENT_LIST].size > ghost[FREQUENT_LIST].size) ? ghost[RECENT_LIST].size / ghost[FREQUENT_LIST].size : 1;
+		target = (target - delta > 0) ? target - delta : 0;
+	}
+	state->nextTarget = target;
+
+	int list = (resident[RECENT_LIST].size > 0 && (resident[RECENT_LIST].size > target ||
+		(ghostList == FREQUENT_LIST && resident[RECENT_LIST].size == target))) ? RECENT_LIST : FREQUENT_LIST;
+	int victimIndex = pickFromLists(state, bm, list);
+
+	// Without an eviction neither the ghost hit nor the new target count
+	if (victimIndex == -1)
+	{
+		state->incomingGhost = -1;
+		state->nextTarget = state->recentTarget;
+	}
+	return victimIndex;
+}
+
+static void arcOnEvict(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	ListHead *resident = state->resident;
+	ListHead *ghost = state->ghost;
+	state->recentTarget = state->nextTarget;
+
+	// Keeping the directory (T1 + B1 and all four lists together) within its bounds before the victim becomes a ghost.
+	// If T1 alone fills the pool its victim is not remembered at all.
+	bool rememberVictim = true;
+	if (state->incomingGhost != -1)
+	{
+		removeGhost(state, state->incomingGhost);
+		state->incomingGhost = -1;
+		state->incomingFrequent = true;
+	}
+	else if (resident[RECENT_LIST].size + ghost[RECENT_LIST].size >= state->capacity)
+	{
+		if (ghost[RECENT_LIST].size > 0)
+			removeGhost(state, ghost[RECENT_LIST].last);
+		else
+			rememberVictim = false;
+	}
+	else if (resident[RECENT_LIST].size + resident[FREQUENT_LIST].size + ghost[RECENT_LIST].size + ghost[FREQUENT_LIST].size >= 2 * state->capacity
+		&& ghost[FREQUENT_LIST].size > 0)
+		removeGhost(state, ghost[FREQUENT_LIST].last);
+
+	if (rememberVictim)
+		addGhost(state, state->frameList[frameIndex], pageNum);
+	unlinkListEntry(&resident[state->frameList[frameIndex]], state->framePrev, state->frameNext, frameIndex);
+	state->frameList[frameIndex] = -1;
+}
+
+// A page removed without pickVictim is remembered like an evicted one, the page loaded next was not looked up in the
+// ghost lists and the target of T1 stays
+static void twoQOnRemove(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	((ScanResistantState *)policyData)->incomingGhost = -1;
+	twoQOnEvict(policyData, frameIndex, pageNum);
+}
+
+static void arcOnRemove(void *policyData, int frameIndex, PageNumber pageNum)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	state->incomingGhost = -1;
+	state->nextTarget = state->recentTarget;
+	arcOnEvict(policyData, frameIndex, pageNum);
+}
+
+// The frames that stay keep their list and their order in it
+static void moveResidentFrames(ScanResistantState *state, ScanResistantState *newState, const int *frameMap)
+{
+	int list;
+	for (list = 0; list < 2; list++)
+	{
+		int frameIndex;
+		for (frameIndex = state->resident[list].last; frameIndex != -1; frameIndex = state->framePrev[frameIndex])
+			if (frameMap[frameIndex] != -1)
+				moveFrameToList(newState, frameMap[frameIndex], list);
+	}
+}
+
+// Copies the newest 'limit' entries of ghost list 'list' into the new state, in their order
+static void copyGhosts(ScanResistantState *state, ScanResistantState *newState, int list, int limit)
+{
+	int numSkipped = state->ghost[list].size - limit;
+	int ghost;
+	for (ghost = state->ghost[list].last; ghost != -1; ghost = state->ghostPrev[ghost])
+		if (numSkipped-- <= 0)
+			addGhost(newState, list, state->ghostPage[ghost]);
+}
+
+// A1out keeps at most ghostLimit entries of the new size
+static void twoQResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	ScanResistantState *newState = (ScanResistantState *)newPolicyData;
+	moveResidentFrames(state, newState, frameMap);
+	copyGhosts(state, newState, RECENT_LIST, newState->ghostLimit);
+}
+
+// T1 and B1 together stay within the new capacity, all four lists within twice of it. The target length of T1 is kept.
+static void arcResize(void *policyData, void *newPolicyData, const int *frameMap, int numFrames)
+{
+	ScanResistantState *state = (ScanResistantState *)policyData;
+	ScanResistantState *newState = (ScanResistantState *)newPolicyData;
+	moveResidentFrames(state, newState, frameMap);
+	copyGhosts(state, newState, RECENT_LIST, newState->capacity - newState->resident[RECENT_LIST].size);
+	copyGhosts(state, newState, FREQUENT_LIST, newState->capacity - newState->ghost[RECENT_LIST].size);
+	newState->recentTarget = (state->recentTarget < newState->capacity) ? state->recentTarget : newState->capacity;
+}
+
+#pragma endregion
+
+// ***** POLICY TABLE ***** //
+#pragma region POLICY TABLE
+
+static const BM_ReplacementPolicy fifoPolicy = {
+	"FIFO", queueInit, queueShutdown, queueOnLoad, NULL, NULL, queuePickVictim, queueOnEvict, queueResize, queueInitFrom, NULL
+};
+
+static const BM_ReplacementPolicy lruPolicy = {
+	"LRU", queueInit, queueShutdown, queueOnLoad, queueOnHit, NULL, queuePickVictim, queueOnEvict, queueResize, queueInitFrom, NULL
+};
+
+static const BM_ReplacementPolicy clockPolicy = {
+	"CLOCK", clockInit, clockShutdown, clockOnLoad, clockOnHit, NULL, clockPickVictim, NULL, clockResize, clockInitFrom, NULL
+};
+
+static const BM_ReplacementPolicy lfuPolicy = {
+	"LFU", lfuInit, lfuShutdown, lfuOnLoad, lfuOnHit, NULL, lfuPickVictim, lfuOnEvict, lfuResize, lfuInitFrom, NULL
+};
+
+static const BM_ReplacementPolicy lruKPolicy = {
+	"LRU-K", lruKInit, lruKShutdown, lruKOnLoad, lruKOnHit, lruKOnUnpin, lruKPickVictim, lruKOnEvict, lruKResize, lruKInitFrom, NULL
+};
+
+static const BM_ReplacementPolicy twoQPolicy = {
+	"2Q", twoQInit, scanResistantShutdown, scanResistantOnLoad, twoQOnHit, NULL, twoQPickVictim, twoQOnEvict, twoQResize, scanResistantInitFrom, twoQOnRemove
+};
+
+static const BM_ReplacementPolicy arcPolicy = {
+	"ARC", arcInit, scanResistantShutdown, scanResistantOnLoad, arcOnHit, NULL, arcPickVictim, arcOnEvict, arcResize, scanResistantInitFrom, arcOnRemove
+};
+
+extern const BM_ReplacementPolicy *getReplacementPolicy (ReplacementStrategy strategy)
+{
+	switch (strategy)
+	{
+	case RS_FIFO:
+		return &fifoPolicy;
+	case RS_LRU:
+		return &lruPolicy;
+	case RS_CLOCK:
+		return &clockPolicy;
+	case RS_LFU:
+		return &lfuPolicy;
+	case RS_LRU_K:
+		return &lruKPolicy;
+	case RS_2Q:
+		return &twoQPolicy;
+	case RS_ARC:
+		return &arcPolicy;
+	default:
+		return NULL;
+	}
+}
+
+#pragma endregion
@@ -0,0 +1,58 @@
+#ifndef BUFFER_MGR_POLICY_H
+#define BUFFER_MGR_POLICY_H
+
+#include "dberror.h"
+#include "buffer_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+/* A page replacement policy. The buffer pool calls the hooks with the policy's own state (policyData) and
+   identifies frames by their index 0 .. numFrames-1. A partitioned pool keeps one state per partition, numFrames
+   and the frame indexes are then those of the partition. The optional hooks may be NULL. The hooks are called with
+   the partition latch held, so they never run concurrently for one state and must not call buffer manager functions
+   other than getFrameFixCount.
+
+   init        creates the state for a pool of numFrames frames, stratData as passed to initBufferPool. The pool
+               does not keep stratData, the state has to copy the settings it needs from it.
+   shutdown    releases the state (optional)
+   onLoad      a frame got page pageNum, read from disk; the frame is pinned
+   onHit       the page of a frame was pinned again while it was in the pool (optional)
+   onUnpin     the fix count of a frame dropped to 0 (optional)
+   pickVictim  returns the frame whose page is replaced by page pageNum, -1 if every candidate is pinned.
+               The returned frame is evicted right away: onEvict and onLoad follow for it. Nothing follows if
+               it returns -1, the state must not expect an onEvict then.
+   onEvict     the page pageNum of a frame chosen by pickVictim is evicted (optional)
+   resize      the pool was resized: carries what the state knows about the frames that stay over into newPolicyData,
+               the state created for the new frame count (optional). frameMap[i] is the new index of frame i of the
+               numFrames old frames, -1 if the frame was dropped. The old state is released by shutdown afterwards.
+               Without the hook the new state is told about the pages that stay through onLoad and onUnpin.
+   initFrom    creates the state for a resized pool of numFrames frames with the settings of the state policyData
+               was created with (optional). Without it a pool can only be resized if stratData was NULL, init is
+               then called again with NULL.
+   onRemove    the page pageNum of a frame leaves the pool without pickVictim choosing it: an access strategy
+               recycles the frame, or the page could not be loaded (optional, onEvict is called if it is NULL) */
+typedef struct BM_ReplacementPolicy {
+  const char *name;
+  RC (*init) (void **policyData, int numFrames, void *stratData);
+  void (*shutdown) (void *policyData);
+  void (*onLoad) (void *policyData, int frameIndex, PageNumber pageNum);
+  void (*onHit) (void *policyData, int frameIndex);
+  void (*onUnpin) (void *policyData, int frameIndex);
+  int (*pickVictim) (void *policyData, BM_BufferPool *const bm, PageNumber pageNum);
+  void (*onEvict) (void *policyData, int frameIndex, PageNumber pageNum);
+  void (*resize) (void *policyData, void *newPolicyData, const int *frameMap, int numFrames);
+  RC (*initFrom) (void *policyData, void **newPolicyData, int numFrames);
+  void (*onRemove) (void *policyData, int frameIndex, PageNumber pageNum);
+} BM_ReplacementPolicy;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* the built-in policy of a replacement strategy, NULL for an unknown strategy */
+extern const BM_ReplacementPolicy *getReplacementPolicy (ReplacementStrategy strategy);
+
+/* number of clients that have the page of the frame pinned, for pickVictim */
+extern int getFrameFixCount (BM_BufferPool *const bm, int frameIndex);
+
+#endif
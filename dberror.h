@@ -44,6 +44,11 @@ typedef int RC;
 #define RC_RM_NO_TUPLE_WITH_GIVEN_RID 600
 #define RC_SCAN_CONDITION_NOT_FOUND 601
 
+// Added new definitions for Storage Manager
+#define RC_BUFFER_NOT_ALIGNED 700
+#define RC_PAGE_CHECKSUM_MISMATCH 701
+#define RC_FILE_FORMAT_NOT_SUPPORTED 702
+
 /* holder for error messages */
 extern char *RC_message;
 
@@ -11,6 +11,8 @@ const int ATTRIBUTE_SIZE = 20; // Size of the name of the attribute
 const int FIRST_PAGE_NUMBER = 0;
 const int FIRSTPAGE_POS = 1;
 const int FIRSTSLOT_POS = 0;
+const int SCAN_PREFETCH_PAGES = 8; // pages a scan asks the buffer pool to read ahead
+const int BULK_RING_SIZE = 32; // frames a scan or the inserts into a table recycle instead of evicting other pages
 
 RecordManager *recordManager;
 BM_BufferPool *bufferPool;
@@ -27,11 +29,11 @@ int *incrementPointer(char *pointer, int offset)
 }
 
 // This function returns the index of a free slot
-int getFreeSlotIndex(char *data, int recordSize)
+int getFreeSlotIndex(char *data, int recordSize, int pageSize)
 {
 	int index = 0;
 	int offset;
-	int totalSlots = PAGE_SIZE / recordSize;
+	int totalSlots = pageSize / recordSize;
 
 	while (index < totalSlots)
 	{
@@ -71,11 +73,29 @@ extern RC shutdownRecordManager()
 	return RC_OK;
 }
 
-// This function creates a Table
+// This function creates a Table in a plain page file with the default page size
 extern RC createTable(char *name, Schema *schema)
+{
+	return createTableWithFormat(name, schema, NULL);
+}
+
+// This function creates a Table whose page file uses pages of pageSize bytes
+extern RC createTableWithPageSize(char *name, Schema *schema, int pageSize)
+{
+	SM_FileFormat format = { .pageSize = pageSize };
+	return createTableWithFormat(name, schema, &format);
+}
+
+// This function creates a Table whose page file has the given format (NULL for a plain page file)
+extern RC createTableWithFormat(char *name, Schema *schema, const SM_FileFormat *format)
 {
 	int result;
-	char data[PAGE_SIZE];
+	int pageSize = (format != NULL && format->pageSize != 0) ? format->pageSize : PAGE_SIZE;
+
+	// The schema is written to the first page, which has to be large enough to hold it
+	if (pageSize < (int)(4 * sizeof(int)) + schema->numAttr * (ATTRIBUTE_SIZE + 2 * (int)sizeof(int)))
+		return RC_ERROR;
+	char *data = (char *)calloc(pageSize, sizeof(char));
 	char *pageHandle = data;
 
 	int const NUMBER_OF_TUPLES = 0;
@@ -85,9 +105,6 @@ extern RC createTable(char *name, Schema *schema)
 	recordManager = (RecordManager *)malloc(sizeof(RecordManager));
 	bufferPool = &recordManager->bufferPool;
 
-	// Initalizing the Buffer Pool using the default page replacement strategy
-	initBufferPool(bufferPool, name, NUMBER_OF_PAGES_IN_BUFFER_POOL, DEFAULT_REPLACEMENT_STRATEGY, NULL);
-
 	int tableCreationAttributes[] = {NUMBER_OF_TUPLES, FIRSTPAGE_POS, schema->numAttr, schema->keySize};
 	int tableCreationAttributesSize = sizeof(tableCreationAttributes) / sizeof(tableCreationAttributes[0]);
 	int iter = 0;
@@ -119,7 +136,7 @@ extern RC createTable(char *name, Schema *schema)
 	bool isExceptionPresent = true;
 
 	// Check page file creation with page name as table name
-	if ((result = createPageFile(name)) != RC_OK)
+	if ((result = createPageFileWithFormat(name, format)) != RC_OK)
 		;
 
 	// Check the success of opening the newly created page
@@ -134,9 +151,19 @@ extern RC createTable(char *name, Schema *schema)
 	else if ((result = closePageFile(&fileHandle)) != RC_OK)
 		;
 
+	// Initalizing the Buffer Pool using the default page replacement strategy, the pool opens the page file created above
+	else if ((result = initBufferPool(bufferPool, name, NUMBER_OF_PAGES_IN_BUFFER_POOL, DEFAULT_REPLACEMENT_STRATEGY, NULL)) != RC_OK)
+		;
+
+	// The inserts search for free slots through their own ring of frames
+	else if ((result = initAccessStrategy(&recordManager->accessStrategy, BULK_RING_SIZE)) != RC_OK)
+		;
+
 	else
 		isExceptionPresent = false;
 
+	free(data);
+
 	// return the exception if there exists one
 	if (isExceptionPresent == true)
 	{
@@ -233,6 +260,7 @@ extern RC closeTable(RM_TableData *rel)
 {
 	RecordManager *recordManager = rel->mgmtData;
 	bufferPool = &recordManager->bufferPool;
+	freeAccessStrategy(&recordManager->accessStrategy);
 	shutdownBufferPool(bufferPool);
 	return RC_OK;
 }
@@ -289,14 +317,14 @@ extern RC insertRecord(RM_TableData *rel, Record *record)
 			recordID->page++;
 		}
 
-		// Bring the new page into the Buffer Pool
-		pinPage(bufferPool, pageHandle, recordID->page);
+		// Bring the new page into the Buffer Pool, recycling the frames of the pages searched before
+		pinPageWithStrategy(bufferPool, pageHandle, recordID->page, &recordManager->accessStrategy);
 
 		// Setting the data to initial position of record's data
 		data = recordManager->pageHandle.data;
 
 		// Search again for a free slot
-		recordID->slot = getFreeSlotIndex(data, recordSize);
+		recordID->slot = getFreeSlotIndex(data, recordSize, bufferPool->pageSize);
 	}
 
 	recordPointer = data;
@@ -486,6 +514,17 @@ extern RC startScan(RM_TableData *rel, RM_ScanHandle *scan, Expr *cond)
 	// setting the table that needs to be scanned
 	scan->rel = rel;
 
+	// The scan reads the table through its own ring of frames, so that it does not evict the pages other clients use
+	RC result = initAccessStrategy(&scanManager->accessStrategy, BULK_RING_SIZE);
+	if (result != RC_OK)
+	{
+		free(scanManager);
+		return result;
+	}
+
+	// The first pages of the table are read in the background while the scan starts
+	prefetchPagesWithStrategy(&tableManager->bufferPool, FIRSTPAGE_POS, SCAN_PREFETCH_PAGES, &scanManager->accessStrategy);
+
 	return RC_OK;
 }
 
@@ -510,7 +549,7 @@ extern RC next(RM_ScanHandle *scan, Record *record)
 	int sizeOfRecord = getRecordSize(schema);
 
 	//  Total number of slots to be calculated
-	int totalSlotsCount = PAGE_SIZE / sizeOfRecord;
+	int totalSlotsCount = scanTableManager->bufferPool.pageSize / sizeOfRecord;
 
 	// Scan count retrieval
 	int scanCount = scanManager->scanCount;
@@ -536,6 +575,10 @@ extern RC next(RM_ScanHandle *scan, Record *record)
 			{
 				scanManager->recordID.slot = FIRSTSLOT_POS;
 				scanManager->recordID.page++;
+
+				// Asking the buffer pool to read the next pages while this one is scanned
+				prefetchPagesWithStrategy(&scanTableManager->bufferPool, scanManager->recordID.page + 1, SCAN_PREFETCH_PAGES,
+										  &scanManager->accessStrategy);
 			}
 		}
 		else
@@ -546,7 +589,7 @@ extern RC next(RM_ScanHandle *scan, Record *record)
 		}
 
 		// Pinning the page i.e. putting the page in buffer pool
-		pinPage(&scanTableManager->bufferPool, &scanManager->pageHandle, scanManager->recordID.page);
+		pinPageWithStrategy(&scanTableManager->bufferPool, &scanManager->pageHandle, scanManager->recordID.page, &scanManager->accessStrategy);
 
 		data = scanManager->pageHandle.data;
 
@@ -611,6 +654,7 @@ extern RC closeScan(RM_ScanHandle *scan)
 	}
 
 	// De-allocate all the memory space
+	freeAccessStrategy(&scanManager->accessStrategy);
 	scanManager = NULL;
 	free(scanManager);
 
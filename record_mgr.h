@@ -5,6 +5,7 @@
 #include "expr.h"
 #include "tables.h"
 #include "record_mgr.h"
+#include "storage_mgr.h"
 #include "buffer_mgr.h"
 
 // Bookkeeping for scans
@@ -31,12 +32,16 @@ typedef struct RecordManager
 	RID firstFreePage;
 	// Stores the count of the number of records scanned
 	int scanCount;
+	// Ring of frames used by the scan, or by the free slot search of inserts into the table
+	BM_AccessStrategy accessStrategy;
 } RecordManager;
 
 // table and manager
 extern RC initRecordManager (void *mgmtData);
 extern RC shutdownRecordManager ();
 extern RC createTable (char *name, Schema *schema);
+extern RC createTableWithPageSize (char *name, Schema *schema, int pageSize);
+extern RC createTableWithFormat (char *name, Schema *schema, const SM_FileFormat *format);
 extern RC openTable (RM_TableData *rel, char *name);
 extern RC closeTable (RM_TableData *rel);
 extern RC deleteTable (char *name);
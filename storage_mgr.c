@@ -1,417 +1,1114 @@
+#define _GNU_SOURCE
+
 #include<stdio.h>
 #include<stdlib.h>
 #include<sys/stat.h>
 #include<sys/types.h>
+#include<sys/mman.h>
+#include<sys/uio.h>
+#include<fcntl.h>
+#include<errno.h>
+#include<limits.h>
 #include<unistd.h>
 #include<string.h>
 #include<math.h>
+#include<stdint.h>
+#include<stddef.h>
 
 #include "storage_mgr.h"
+#include "storage_mgr_compress.h"
+#include "dt.h"
 
-FILE *pageFile;
+#if defined(__x86_64__)
+#include<nmmintrin.h>
+#endif
 
-extern void initStorageManager (void) {
-	// Initialising file pointer i.e. storage manager.
-	pageFile = NULL;
+// Book-keeping stored in fHandle->mgmtInfo for every open page file.
+// The descriptor stays open from openPageFile until closePageFile, so reading or writing
+// a block costs a single positional system call instead of fopen + fseek + fclose.
+// In the SM_IO_MMAP modes the whole file is also mapped, and blocks are copied from and to the mapping.
+typedef struct SM_FileInfo {
+	int fd;
+	SM_IOMode ioMode;
+	// size of the pages of this file, recorded in the file header
+	int pageSize;
+	char *mapAddress;
+	size_t mapSize;
+	// Pages the file system has reserved for the file. This can be more than totalNumPages, which only counts the logical pages.
+	int allocatedPages;
+	// Growth policy: pages reserved at once, or SM_GROWTH_GEOMETRIC to double the reservation
+	int growthExtent;
+	// Cleared when the file system does not support fallocate, the file then grows without reservation.
+	bool canPreallocate;
+	// Layout of the file: page i starts at dataOffset + i * pageStride. Files created by createPageFile have
+	// no file header and no page headers, there pages simply follow each other.
+	off_t dataOffset;
+	size_t pageStride;
+	// every page is preceded by an SM_PageHeader holding its checksum
+	bool checksums;
+	bool verifyChecksums;
+	// Compressed files store every page as a record somewhere behind the file header, pageMap tells where.
+	// New records are appended at dataEnd.
+	bool compressed;
+	struct SM_PageLocation *pageMap;
+	int pageMapCapacity;
+	off_t dataEnd;
+} SM_FileInfo;
+
+// File header at the start of files created with createPageFileWithFormat
+typedef struct SM_FileHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	// Compressed files: the page map written by closePageFile. mapOffset is 0 while the file is open,
+	// if the file was not closed the map is rebuilt from the page records.
+	uint64_t mapOffset;
+	uint32_t mapPages;
+	uint32_t mapChecksum;
+	// page size of the file, 0 in files that were created before it was recorded means PAGE_SIZE
+	uint32_t pageSize;
+} SM_FileHeader;
+
+#define SM_FILE_MAGIC "DBPAGEF1"
+#define SM_FILE_VERSION 1
+#define SM_FILE_FLAG_CHECKSUMS 0x1
+#define SM_FILE_FLAG_COMPRESSED 0x2
+
+// Where the record of a page of a compressed file is, offset 0 for a page that was never written (all zeros)
+typedef struct SM_PageLocation {
+	uint64_t offset;
+	uint32_t length;   // size of the compressed page, the page size if it is stored uncompressed
+	uint32_t capacity; // space reserved for the record, a rewrite that fits stays in place
+} SM_PageLocation;
+
+// Header of a page record in a compressed file
+typedef struct SM_PageRecord {
+	uint32_t magic;
+	uint32_t pageNum;
+	uint32_t length;
+	uint32_t capacity;
+	uint32_t checksum; // CRC32C of the page number and the stored bytes
+} SM_PageRecord;
+
+#define SM_PAGE_RECORD_MAGIC 0x43504752
+// record capacities are rounded up to this size, so a page can grow a little without moving
+#define SM_PAGE_RECORD_ALIGNMENT 256
+
+// ***** HELPER FUNCTIONS ***** //
+
+// Returns the book-keeping of an open file handle or NULL if the handle has not been opened.
+static SM_FileInfo *getFileInfo(SM_FileHandle *fHandle) {
+	if(fHandle == NULL)
+		return NULL;
+	return (SM_FileInfo *)fHandle->mgmtInfo;
 }
 
-extern RC createPageFile (char *fileName) {
-	// Opening file stream in read & write mode. 'w+' mode creates an empty file for both reading and writing.
-	pageFile = fopen(fileName, "w+");
+// O_DIRECT transfers fail with EINVAL on misaligned buffers, we report that before issuing them.
+static bool isTransferAllowed(SM_FileInfo *info, SM_PageHandle memPage) {
+	return info->ioMode != SM_IO_DIRECT || ((size_t)memPage % SM_DIRECT_IO_ALIGNMENT) == 0;
+}
 
-	// Checking if file was successfully opened.
-	if(pageFile == NULL) {
-		return RC_FILE_NOT_FOUND;
-	} else {
-		// Creating an empty page in memory.
-		SM_PageHandle emptyPage = (SM_PageHandle)calloc(PAGE_SIZE, sizeof(char));
-		
-		// Writing empty page to file.
-		if(fwrite(emptyPage, sizeof(char), PAGE_SIZE,pageFile) < PAGE_SIZE)
-			printf("write failed \n");
-		else
-			printf("write succeeded \n");
-		
-		// Closing file stream so that all the buffers are flushed. 
-		fclose(pageFile);
-		
-		// De-allocating the memory previously allocated to 'emptyPage'.
-		// This is optional but always better to do for proper memory management.
-		free(emptyPage);
-		
+// Byte offset of page pageNum in the file
+static off_t pageOffset(SM_FileInfo *info, int pageNum) {
+	return info->dataOffset + (off_t)pageNum * info->pageStride;
+}
+
+// Number of complete pages in a file of 'fileSize' bytes
+static int pagesInFile(SM_FileInfo *info, off_t fileSize) {
+	if(fileSize <= info->dataOffset)
+		return 0;
+	return (fileSize - info->dataOffset) / info->pageStride;
+}
+
+// ***** CHECKSUM FUNCTIONS ***** //
+
+// CRC32C (Castagnoli) lookup table for the portable implementation, filled on first use
+static uint32_t crcTable[256];
+static bool isCrcTableReady = false;
+
+static void initCrcTable(void) {
+	uint32_t iter;
+	for(iter = 0; iter < 256; iter++) {
+		uint32_t crc = iter;
+		int bit;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+		crcTable[iter] = crc;
+	}
+	isCrcTableReady = true;
+}
+
+static uint32_t crc32cPortable(uint32_t crc, const unsigned char *buffer, size_t length) {
+	if(!isCrcTableReady)
+		initCrcTable();
+	while(length-- > 0)
+		crc = crcTable[(crc ^ *buffer++) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+#if defined(__x86_64__)
+// SSE 4.2 has a CRC32C instruction that checksums 8 bytes per instruction
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(uint32_t crc, const unsigned char *buffer, size_t length) {
+	uint64_t crc64 = crc;
+	while(length >= 8) {
+		uint64_t word;
+		memcpy(&word, buffer, 8);
+		crc64 = _mm_crc32_u64(crc64, word);
+		buffer += 8;
+		length -= 8;
+	}
+	crc = (uint32_t)crc64;
+	while(length-- > 0)
+		crc = _mm_crc32_u8(crc, *buffer++);
+	return crc;
+}
+#endif
+
+// Continues the CRC32C 'crc' over 'length' bytes, using the CPU instruction when it is available
+static uint32_t crc32c(uint32_t crc, const void *buffer, size_t length) {
+#if defined(__x86_64__)
+	static int hasHardwareCrc = -1;
+	if(hasHardwareCrc < 0)
+		hasHardwareCrc = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+	if(hasHardwareCrc)
+		return crc32cHardware(crc, (const unsigned char *)buffer, length);
+#endif
+	return crc32cPortable(crc, (const unsigned char *)buffer, length);
+}
+
+// Checksum of a page and its header. The page number is included, so a page written to the wrong place is detected too.
+// 0 is reserved for pages that were never written.
+static uint32_t computePageChecksum(int pageNum, const SM_PageHeader *header, const char *memPage, int pageSize) {
+	uint32_t crc = ~0u;
+	uint32_t pageNumber = (uint32_t)pageNum;
+	crc = crc32c(crc, &pageNumber, sizeof(pageNumber));
+	crc = crc32c(crc, &header->pageType, sizeof(SM_PageHeader) - offsetof(SM_PageHeader, pageType));
+	crc = ~crc32c(crc, memPage, pageSize);
+	return crc == 0 ? 1 : crc;
+}
+
+// Checks a page read from a checksummed file. Pages the file grew by but that were never written are all zeros.
+static RC verifyPage(int pageNum, const SM_PageHeader *header, const char *memPage, int pageSize) {
+	if(header->checksum == 0) {
+		size_t iter;
+		if(header->pageType != SM_PAGE_TYPE_FREE || header->lsn != 0)
+			return RC_PAGE_CHECKSUM_MISMATCH;
+		for(iter = 0; iter < (size_t)pageSize; iter++) {
+			if(memPage[iter] != 0)
+				return RC_PAGE_CHECKSUM_MISMATCH;
+		}
 		return RC_OK;
 	}
+	if(header->checksum != computePageChecksum(pageNum, header, memPage, pageSize))
+		return RC_PAGE_CHECKSUM_MISMATCH;
+	return RC_OK;
 }
 
-extern RC openPageFile (char *fileName, SM_FileHandle *fHandle) {
-	// Opening file stream in read mode. 'r' mode creates an empty file for reading only.
-	pageFile = fopen(fileName, "r");
+// Fills in the header written in front of a page, 'source' supplies the page type and LSN (NULL for a plain data page).
+static void preparePageHeader(int pageNum, SM_PageHeader *header, const SM_PageHeader *source, const char *memPage, int pageSize) {
+	header->pageType = (source != NULL) ? source->pageType : SM_PAGE_TYPE_DATA;
+	header->lsn = (source != NULL) ? source->lsn : 0;
+	header->checksum = computePageChecksum(pageNum, header, memPage, pageSize);
+}
 
-	// Checking if file was successfully opened.
-	if(pageFile == NULL) {
-		return RC_FILE_NOT_FOUND;
-	} else { 
-		// Updating file handle's filename and set the current position to the start of the page.
-		fHandle->fileName = fileName;
-		fHandle->curPagePos = 0;
-
-		/* In order to calculate the total size, we perform following steps -
-		   1. Move the position of the file stream to the end of file
-		   2. Check the file end position
-		   3. Move the position of the file stream to the beginning of file  
-		
-		fseek(pageFile, 0L, SEEK_END);
-		int totalSize = ftell(pageFile);
-		fseek(pageFile, 0L, SEEK_SET);
-		fHandle->totalNumPages = totalSize/ PAGE_SIZE;  */
-		
-		/* Using fstat() to get the file total size.
-		   fstat() is a system call that is used to determine information about a file based on its file descriptor.
-		   'st_size' member variable of the 'stat' structure gives the total size of the file in bytes.
-		*/
-
-		struct stat fileInfo;
-		if(fstat(fileno(pageFile), &fileInfo) < 0)    
+// ***** I/O FUNCTIONS ***** //
+
+// Checks if the handle was opened with one of the memory mapped backends.
+static bool isMapped(SM_FileInfo *info) {
+	return info->ioMode == SM_IO_MMAP || info->ioMode == SM_IO_MMAP_READ_ONLY;
+}
+
+// Reads exactly 'length' bytes at 'offset'. pread() may return less than requested, so we loop until done.
+static RC readFully(int fd, char *buffer, size_t length, off_t offset) {
+	while(length > 0) {
+		ssize_t bytesRead = pread(fd, buffer, length, offset);
+		if(bytesRead < 0 && errno == EINTR)
+			continue;
+		// Reaching end of file before the block is complete means the page does not exist.
+		if(bytesRead == 0)
+			return RC_READ_NON_EXISTING_PAGE;
+		if(bytesRead < 0)
 			return RC_ERROR;
-		fHandle->totalNumPages = fileInfo.st_size/ PAGE_SIZE;
+		buffer += bytesRead;
+		length -= bytesRead;
+		offset += bytesRead;
+	}
+	return RC_OK;
+}
 
-		// Closing file stream so that all the buffers are flushed. 
-		fclose(pageFile);
-		return RC_OK;
+// Writes exactly 'length' bytes at 'offset', looping over short writes.
+static RC writeFully(int fd, const char *buffer, size_t length, off_t offset) {
+	while(length > 0) {
+		ssize_t bytesWritten = pwrite(fd, buffer, length, offset);
+		if(bytesWritten < 0 && errno == EINTR)
+			continue;
+		if(bytesWritten <= 0)
+			return RC_WRITE_FAILED;
+		buffer += bytesWritten;
+		length -= bytesWritten;
+		offset += bytesWritten;
 	}
+	return RC_OK;
 }
 
-extern RC closePageFile (SM_FileHandle *fHandle) {
-	// Checking if file pointer or the storage manager is intialised. If initialised, then close.
-	if(pageFile != NULL)
-		pageFile = NULL;	
-	return RC_OK; 
+// Reads or writes the buffers of 'iov' one after the other starting at 'offset'. preadv()/pwritev() may stop in
+// the middle of a buffer, then the vector is advanced past the transferred bytes and the rest is transferred again.
+static RC transferVectorFully(int fd, struct iovec *iov, int iovCount, off_t offset, bool isWrite) {
+	while(iovCount > 0) {
+		// The kernel accepts at most IOV_MAX buffers per call
+		int batchCount = iovCount < IOV_MAX ? iovCount : IOV_MAX;
+		ssize_t bytesWritten = isWrite ? pwritev(fd, iov, batchCount, offset) : preadv(fd, iov, batchCount, offset);
+		if(bytesWritten < 0 && errno == EINTR)
+			continue;
+		// Reaching end of file before all pages are read means a page does not exist.
+		if(bytesWritten == 0 && !isWrite)
+			return RC_READ_NON_EXISTING_PAGE;
+		if(bytesWritten <= 0)
+			return isWrite ? RC_WRITE_FAILED : RC_ERROR;
+		offset += bytesWritten;
+
+		// Skipping the buffers that were written completely, the first remaining one may be written partially
+		while(iovCount > 0 && (size_t)bytesWritten >= iov->iov_len) {
+			bytesWritten -= iov->iov_len;
+			iov++;
+			iovCount--;
+		}
+		if(iovCount > 0) {
+			iov->iov_base = (char *)iov->iov_base + bytesWritten;
+			iov->iov_len -= bytesWritten;
+		}
+	}
+	return RC_OK;
 }
 
+// (Re)maps the first 'numPages' pages of the file. Called after the file size changed.
+static RC mapFile(SM_FileInfo *info, int numPages) {
+	size_t newSize = (numPages == 0) ? 0 : (size_t)pageOffset(info, numPages);
+	if(newSize == info->mapSize)
+		return RC_OK;
 
-extern RC destroyPageFile (char *fileName) {
-	// Opening file stream in read mode. 'r' mode creates an empty file for reading only.	
-	pageFile = fopen(fileName, "r");
-	
-	if(pageFile == NULL)
-		return RC_FILE_NOT_FOUND; 
-	
-	// Deleting the given filename so that it is no longer accessible.	
-	remove(fileName);
+	// An empty file cannot be mapped, we only drop the old mapping.
+	if(newSize == 0) {
+		if(info->mapAddress != NULL)
+			munmap(info->mapAddress, info->mapSize);
+		info->mapAddress = NULL;
+		info->mapSize = 0;
+		return RC_OK;
+	}
+
+	void *address;
+	int protection = (info->ioMode == SM_IO_MMAP_READ_ONLY) ? PROT_READ : PROT_READ | PROT_WRITE;
+	if(info->mapAddress == NULL)
+		address = mmap(NULL, newSize, protection, MAP_SHARED, info->fd, 0);
+	else
+		address = mremap(info->mapAddress, info->mapSize, newSize, MREMAP_MAYMOVE);
+	if(address == MAP_FAILED)
+		return RC_ERROR;
+
+	info->mapAddress = (char *)address;
+	info->mapSize = newSize;
 	return RC_OK;
 }
 
-extern RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	// Checking if the pageNumber parameter is less than Total number of pages and less than 0, then return respective error code
-	if (pageNum > fHandle->totalNumPages || pageNum < 0)
-        	return RC_READ_NON_EXISTING_PAGE;
+// Makes sure the file system has reserved space for at least 'numPages' pages. Space is reserved a whole
+// extent at a time with fallocate, which neither writes the pages nor changes the file size.
+static void reserveSpace(SM_FileInfo *info, int numPages) {
+	if(numPages <= info->allocatedPages || !info->canPreallocate)
+		return;
 
-	// Opening file stream in read mode. 'r' mode opens file for reading only.	
-	pageFile = fopen(fHandle->fileName, "r");
+	// Rounding the reservation up to the next extent, or doubling it for geometric growth
+	int targetPages;
+	if(info->growthExtent == SM_GROWTH_GEOMETRIC)
+		targetPages = info->allocatedPages * 2;
+	else
+		targetPages = (numPages + info->growthExtent - 1) / info->growthExtent * info->growthExtent;
+	if(targetPages < numPages)
+		targetPages = numPages;
 
-	// Checking if file was successfully opened.
-	if(pageFile == NULL)
-		return RC_FILE_NOT_FOUND;
-	
-	// Setting the cursor(pointer) position of the file stream. Position is calculated by Page Number x Page Size
-	// And the seek is success if fseek() return 0
-	int isSeekSuccess = fseek(pageFile, (pageNum * PAGE_SIZE), SEEK_SET);
-	if(isSeekSuccess == 0) {
-		// We're reading the content and storing it in the location pointed out by memPage.
-		if(fread(memPage, sizeof(char), PAGE_SIZE, pageFile) < PAGE_SIZE)
-			return RC_ERROR;
-	} else {
-		return RC_READ_NON_EXISTING_PAGE; 
+	off_t offset = pageOffset(info, info->allocatedPages);
+	off_t length = pageOffset(info, targetPages) - offset;
+	if(fallocate(info->fd, FALLOC_FL_KEEP_SIZE, offset, length) == 0) {
+		info->allocatedPages = targetPages;
+	} else if(errno == EOPNOTSUPP) {
+		// The file system cannot reserve space, we stop trying.
+		info->canPreallocate = false;
 	}
-    	
-	// Setting the current page position to the cursor(pointer) position of the file stream
-	fHandle->curPagePos = ftell(pageFile); 
-	
-	// Closing file stream so that all the buffers are flushed.     	
-	fclose(pageFile);
-	
-    	return RC_OK;
 }
 
-extern int getBlockPos (SM_FileHandle *fHandle) {
-	// Returning the current page position retrieved from the file handle	
-	return fHandle->curPagePos;
+// ***** COMPRESSED PAGE FUNCTIONS ***** //
+
+// Makes room for 'numPages' entries in the page map of a compressed file.
+static RC ensurePageMapCapacity(SM_FileInfo *info, int numPages) {
+	if(numPages <= info->pageMapCapacity)
+		return RC_OK;
+
+	int newCapacity = info->pageMapCapacity > 0 ? info->pageMapCapacity : 16;
+	while(newCapacity < numPages)
+		newCapacity *= 2;
+	SM_PageLocation *newMap = (SM_PageLocation *)realloc(info->pageMap, sizeof(SM_PageLocation) * newCapacity);
+	if(newMap == NULL)
+		return RC_MELLOC_MEM_ALLOC_FAILED;
+	info->pageMap = newMap;
+	info->pageMapCapacity = newCapacity;
+	return RC_OK;
 }
 
-extern RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	// Opening file stream in read mode. 'r' mode opens the file for reading only.	
-	pageFile = fopen(fHandle->fileName, "r");
-	
-	// Checking if file was successfully opened.
-	if(pageFile == NULL)
-		return RC_FILE_NOT_FOUND;
+static uint32_t computeRecordChecksum(int pageNum, const char *data, uint32_t length) {
+	uint32_t pageNumber = (uint32_t)pageNum;
+	uint32_t crc = crc32c(~0u, &pageNumber, sizeof(pageNumber));
+	return ~crc32c(crc, data, length);
+}
+
+// Rebuilds the page map of a compressed file that was not closed, by walking the page records from the
+// start of the data. A page rewritten into a new record appears again later in the file, so the last record wins.
+// Pages the file grew by but that were never written are not recorded and are lost from the page count.
+static RC rebuildPageMap(SM_FileInfo *info, off_t fileSize, int *numPages) {
+	off_t offset = SM_FILE_HEADER_SIZE;
+	*numPages = 0;
+	while(offset + (off_t)sizeof(SM_PageRecord) <= fileSize) {
+		SM_PageRecord record;
+		if(readFully(info->fd, (char *)&record, sizeof(record), offset) != RC_OK)
+			break;
 
-	int i;
-	for(i = 0; i < PAGE_SIZE; i++) {
-		// Reading a single character from the file
-		char c = fgetc(pageFile);
-	
-		// Checking if we have reached the end of file
-		if(feof(pageFile))
+		// A record cut off by a crash ends the data
+		if(record.magic != SM_PAGE_RECORD_MAGIC || record.length > record.capacity || record.capacity > (uint32_t)info->pageSize
+				|| record.pageNum > INT_MAX - 1 || offset + (off_t)sizeof(record) + record.capacity > fileSize)
 			break;
-		else
-			memPage[i] = c;
+
+		if((int)record.pageNum >= *numPages) {
+			RC result = ensurePageMapCapacity(info, record.pageNum + 1);
+			if(result != RC_OK)
+				return result;
+			memset(&info->pageMap[*numPages], 0, sizeof(SM_PageLocation) * (record.pageNum + 1 - *numPages));
+			*numPages = record.pageNum + 1;
+		}
+		info->pageMap[record.pageNum].offset = offset;
+		info->pageMap[record.pageNum].length = record.length;
+		info->pageMap[record.pageNum].capacity = record.capacity;
+		offset += sizeof(record) + record.capacity;
+	}
+	info->dataEnd = offset;
+	return RC_OK;
+}
+
+// Loads the page map of a compressed file and marks the file as open: the map on disk is dropped, until
+// closePageFile writes it again new records are appended where it was.
+static RC loadPageMap(SM_FileInfo *info, SM_FileHeader *fileHeader, off_t fileSize, int *numPages) {
+	RC result = RC_ERROR;
+	if(fileHeader->mapOffset != 0 && fileHeader->mapOffset + (uint64_t)fileHeader->mapPages * sizeof(SM_PageLocation) <= (uint64_t)fileSize) {
+		result = ensurePageMapCapacity(info, fileHeader->mapPages);
+		if(result == RC_OK)
+			result = readFully(info->fd, (char *)info->pageMap, sizeof(SM_PageLocation) * fileHeader->mapPages, fileHeader->mapOffset);
+		if(result == RC_OK && crc32c(0, info->pageMap, sizeof(SM_PageLocation) * fileHeader->mapPages) != fileHeader->mapChecksum)
+			result = RC_ERROR;
+		*numPages = fileHeader->mapPages;
+		info->dataEnd = fileHeader->mapOffset;
 	}
 
-	// Setting the current page position to the cursor(pointer) position of the file stream
-	fHandle->curPagePos = ftell(pageFile); 
+	// Without a valid map the file was not closed properly
+	if(result != RC_OK) {
+		result = rebuildPageMap(info, fileSize, numPages);
+		if(result != RC_OK)
+			return result;
+	}
 
-	// Closing file stream so that all the buffers are flushed.
-	fclose(pageFile);
+	fileHeader->mapOffset = 0;
+	if(writeFully(info->fd, (char *)fileHeader, sizeof(SM_FileHeader), 0) != RC_OK || ftruncate(info->fd, info->dataEnd) < 0)
+		return RC_WRITE_FAILED;
 	return RC_OK;
 }
 
-extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	//printf("CURRENT PAGE POSITION = %d \n", fHandle->curPagePos);
-	//printf("TOTAL PAGES = %d \n", fHandle->totalNumPages)
+// Writes the page map behind the last record and records it in the file header.
+static RC storePageMap(SM_FileInfo *info, int numPages) {
+	size_t mapSize = sizeof(SM_PageLocation) * numPages;
+	RC result = writeFully(info->fd, (char *)info->pageMap, mapSize, info->dataEnd);
+	if(result != RC_OK)
+		return result;
+	if(ftruncate(info->fd, info->dataEnd + mapSize) < 0)
+		return RC_WRITE_FAILED;
 
-	// Checking if we are on the first block because there's no other previous block to read
-	if(fHandle->curPagePos <= PAGE_SIZE) {
-		printf("\n First block: Previous block not present.");
-		return RC_READ_NON_EXISTING_PAGE;	
-	} else {
-		// Calculating current page number by dividing page size by current page position	
-		int currentPageNumber = fHandle->curPagePos / PAGE_SIZE;
-		int startPosition = (PAGE_SIZE * (currentPageNumber - 2));
-
-		// Opening file stream in read mode. 'r' mode opens the file for reading only.	
-		pageFile = fopen(fHandle->fileName, "r");
-		
-		// Checking if file was successfully opened.
-		if(pageFile == NULL)
-			return RC_FILE_NOT_FOUND;
-
-		// Initializing file pointer position.
-		fseek(pageFile, startPosition, SEEK_SET);
-		
-		int i;
-		// Reading block character by character and storing it in memPage
-		for(i = 0; i < PAGE_SIZE; i++) {
-			memPage[i] = fgetc(pageFile);
-		}
+	SM_FileHeader fileHeader;
+	result = readFully(info->fd, (char *)&fileHeader, sizeof(fileHeader), 0);
+	if(result != RC_OK)
+		return result;
+	fileHeader.mapOffset = info->dataEnd;
+	fileHeader.mapPages = numPages;
+	fileHeader.mapChecksum = crc32c(0, info->pageMap, mapSize);
+	return writeFully(info->fd, (char *)&fileHeader, sizeof(fileHeader), 0);
+}
+
+// Checks a page record read into 'buffer' and restores the page from it.
+static RC decodePageRecord(SM_FileInfo *info, int pageNum, char *buffer, SM_PageHandle memPage) {
+	SM_PageLocation *location = &info->pageMap[pageNum];
 
-		// Setting the current page position to the cursor(pointer) position of the file stream
-		fHandle->curPagePos = ftell(pageFile); 
+	SM_PageRecord *record = (SM_PageRecord *)buffer;
+	char *data = buffer + sizeof(SM_PageRecord);
+	if(record->magic != SM_PAGE_RECORD_MAGIC || record->pageNum != (uint32_t)pageNum || record->length != location->length)
+		return RC_PAGE_CHECKSUM_MISMATCH;
+	if(info->verifyChecksums && record->checksum != computeRecordChecksum(pageNum, data, record->length))
+		return RC_PAGE_CHECKSUM_MISMATCH;
 
-		// Closing file stream so that all the buffers are flushed.
-		fclose(pageFile);
+	// Pages that did not compress are stored as they are
+	if(record->length == (uint32_t)info->pageSize) {
+		memcpy(memPage, data, info->pageSize);
 		return RC_OK;
 	}
+	// A block that does not decompress is damaged like a page with a wrong checksum
+	if(decompressBlock(data, record->length, memPage, info->pageSize) != RC_OK)
+		return RC_PAGE_CHECKSUM_MISMATCH;
+	return RC_OK;
 }
 
-extern RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	// Calculating current page number by dividing page size by current page position	
-	int currentPageNumber = fHandle->curPagePos / PAGE_SIZE;
-	int startPosition = (PAGE_SIZE * (currentPageNumber - 2));
-	
-	// Opening file stream in read mode. 'r' mode opens the file for reading only.	
-	pageFile = fopen(fHandle->fileName, "r");
+// Reads a page of a compressed file and decompresses it into memPage.
+static RC readCompressedPage(SM_FileInfo *info, int pageNum, SM_PageHandle memPage) {
+	SM_PageLocation *location = &info->pageMap[pageNum];
 
-	// Checking if file was successfully opened.
-	if(pageFile == NULL)
-		return RC_FILE_NOT_FOUND;
+	// A page that was never written reads as zeros
+	if(location->offset == 0) {
+		memset(memPage, 0, info->pageSize);
+		return RC_OK;
+	}
 
-	// Initializing file pointer position.
-	fseek(pageFile, startPosition, SEEK_SET);
-	
-	int i;
-	// Reading block character by character and storing it in memPage.
-	// Also checking if we have reahed end of file.
-	for(i = 0; i < PAGE_SIZE; i++) {
-		char c = fgetc(pageFile);		
-		if(feof(pageFile))
-			break;
-		memPage[i] = c;
+	// Reading the record header and the stored bytes with one read
+	char *buffer = (char *)malloc(sizeof(SM_PageRecord) + location->length);
+	RC result = readFully(info->fd, buffer, sizeof(SM_PageRecord) + location->length, location->offset);
+	if(result == RC_OK)
+		result = decodePageRecord(info, pageNum, buffer, memPage);
+	free(buffer);
+	return result;
+}
+
+// Compresses a page and writes it into its record. The record is rewritten in place if the page still
+// fits into it, otherwise a new record is appended and the old one is abandoned.
+static RC writeCompressedPage(SM_FileInfo *info, int pageNum, SM_PageHandle memPage) {
+	char *compressed = (char *)malloc(info->pageSize);
+	static const char padding[SM_PAGE_RECORD_ALIGNMENT];
+	SM_PageRecord record;
+	char *data = compressed;
+
+	// Storing the page uncompressed if compression does not save anything
+	int length = compressBlock(memPage, info->pageSize, compressed, info->pageSize - 1);
+	if(length == 0) {
+		data = memPage;
+		length = info->pageSize;
 	}
-	
-	// Setting the current page position to the cursor(pointer) position of the file stream
-	fHandle->curPagePos = ftell(pageFile); 
 
-	// Closing file stream so that all the buffers are flushed.
-	fclose(pageFile);
-	return RC_OK;		
+	SM_PageLocation *location = &info->pageMap[pageNum];
+	bool isNewRecord = (location->offset == 0 || (uint32_t)length > location->capacity);
+	if(isNewRecord) {
+		uint32_t capacity = (length + SM_PAGE_RECORD_ALIGNMENT - 1) / SM_PAGE_RECORD_ALIGNMENT * SM_PAGE_RECORD_ALIGNMENT;
+		location->offset = info->dataEnd;
+		location->capacity = capacity < (uint32_t)info->pageSize ? capacity : (uint32_t)info->pageSize;
+		info->dataEnd += sizeof(SM_PageRecord) + location->capacity;
+	}
+	location->length = length;
+
+	record.magic = SM_PAGE_RECORD_MAGIC;
+	record.pageNum = pageNum;
+	record.length = length;
+	record.capacity = location->capacity;
+	record.checksum = computeRecordChecksum(pageNum, data, length);
+
+	// A new record is padded to its capacity, so that the file reaches the start of the next record. Its capacity is
+	// rounded up by less than SM_PAGE_RECORD_ALIGNMENT bytes. A record rewritten in place keeps the bytes behind the
+	// new page, its length tells where the page ends.
+	struct iovec iov[3];
+	int iovCount = 2;
+	iov[0].iov_base = &record;
+	iov[0].iov_len = sizeof(record);
+	iov[1].iov_base = data;
+	iov[1].iov_len = length;
+	if(isNewRecord && location->capacity > (uint32_t)length) {
+		iov[2].iov_base = (void *)padding;
+		iov[2].iov_len = location->capacity - length;
+		iovCount = 3;
+	}
+	RC result = transferVectorFully(info->fd, iov, iovCount, location->offset, true);
+	free(compressed);
+	return result;
 }
 
-extern RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage){
-	// Checking if we are on the last block because there's no next block to read
-	if(fHandle->curPagePos == PAGE_SIZE) {
-		printf("\n Last block: Next block not present.");
-		return RC_READ_NON_EXISTING_PAGE;	
-	} else {
-		// Calculating current page number by dividing page size by current page position	
-		int currentPageNumber = fHandle->curPagePos / PAGE_SIZE;
-		int startPosition = (PAGE_SIZE * (currentPageNumber - 2));
-
-		// Opening file stream in read mode. 'r' mode opens the file for reading only.	
-		pageFile = fopen(fHandle->fileName, "r");
-		
-		// Checking if file was successfully opened.
-		if(pageFile == NULL)
-			return RC_FILE_NOT_FOUND;
-		
-		// Initializing file pointer position.
-		fseek(pageFile, startPosition, SEEK_SET);
-		
-		int i;
-		// Reading block character by character and storing it in memPage.
-		// Also checking if we have reahed end of file.
-		for(i = 0; i < PAGE_SIZE; i++) {
-			char c = fgetc(pageFile);		
-			if(feof(pageFile))
-				break;
-			memPage[i] = c;
-		}
+// Extends the file with zero-filled pages until it holds 'numPages' pages.
+static RC growFile(SM_FileInfo *info, SM_FileHandle *fHandle, int numPages) {
+	if(numPages <= fHandle->totalNumPages)
+		return RC_OK;
 
-		// Setting the current page position to the cursor(pointer) position of the file stream
-		fHandle->curPagePos = ftell(pageFile); 
+	// A read-only mapping can never grow.
+	if(info->ioMode == SM_IO_MMAP_READ_ONLY)
+		return RC_WRITE_FAILED;
 
-		// Closing file stream so that all the buffers are flushed.
-		fclose(pageFile);
+	// New pages of a compressed file only get an empty map entry, they take no space until they are written.
+	if(info->compressed) {
+		RC result = ensurePageMapCapacity(info, numPages);
+		if(result != RC_OK)
+			return result;
+		memset(&info->pageMap[fHandle->totalNumPages], 0, sizeof(SM_PageLocation) * (numPages - fHandle->totalNumPages));
+		fHandle->totalNumPages = numPages;
 		return RC_OK;
 	}
+
+	// Another handle on the same file may have grown it meanwhile, we must not overwrite its pages with zeros.
+	struct stat fileInfo;
+	if(fstat(info->fd, &fileInfo) == 0 && pagesInFile(info, fileInfo.st_size) > fHandle->totalNumPages) {
+		fHandle->totalNumPages = pagesInFile(info, fileInfo.st_size);
+		if(isMapped(info) && mapFile(info, fHandle->totalNumPages) != RC_OK)
+			return RC_ERROR;
+		if(numPages <= fHandle->totalNumPages)
+			return RC_OK;
+	}
+
+	// Reserving the space first, then extending the file size over it. Extending a file with ftruncate
+	// reads back as zeros, so no empty page has to be written.
+	reserveSpace(info, numPages);
+	if(ftruncate(info->fd, pageOffset(info, numPages)) < 0)
+		return RC_WRITE_FAILED;
+
+	// A mapping is grown to cover the new pages.
+	if(info->ioMode == SM_IO_MMAP) {
+		RC result = mapFile(info, numPages);
+		if(result != RC_OK)
+			return result;
+	}
+	fHandle->totalNumPages = numPages;
+	return RC_OK;
 }
 
-extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage){
-	// Opening file stream in read mode. 'r' mode opens the file for reading only.	
-	pageFile = fopen(fHandle->fileName, "r");
+// ***** PAGE FILE FUNCTIONS ***** //
+
+extern void initStorageManager (void) {
+	// The storage manager keeps no global state, every open file carries its own descriptor in the file handle.
+}
+
+extern RC createPageFile (char *fileName) {
+	// Plain page files have neither a file header nor page headers.
+	return createPageFileWithFormat(fileName, NULL);
+}
+
+extern RC createPageFileWithFormat (char *fileName, const SM_FileFormat *format) {
+	// The page size has to be a multiple of SM_MIN_PAGE_SIZE, so that pages stay aligned for O_DIRECT
+	int pageSize = (format != NULL && format->pageSize != 0) ? format->pageSize : PAGE_SIZE;
+	if(pageSize < SM_MIN_PAGE_SIZE || pageSize > SM_MAX_PAGE_SIZE || pageSize % SM_MIN_PAGE_SIZE != 0)
+		return RC_FILE_FORMAT_NOT_SUPPORTED;
+
+	// Creating (or truncating) the file for both reading and writing.
+	int fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644);
 
 	// Checking if file was successfully opened.
-	if(pageFile == NULL)
+	if(fd < 0)
 		return RC_FILE_NOT_FOUND;
-	
-	int startPosition = (fHandle->totalNumPages - 1) * PAGE_SIZE;
-
-	// Initializing file pointer position.
-	fseek(pageFile, startPosition, SEEK_SET);
-	
-	int i;
-	// Reading block character by character and storing it in memPage.
-	// Also checking if we have reahed end of file.
-	for(i = 0; i < PAGE_SIZE; i++) {
-		char c = fgetc(pageFile);		
-		if(feof(pageFile))
-			break;
-		memPage[i] = c;
+
+	// The file header is followed by the first page, which is preceded by its page header for checksummed files.
+	// An all-zero page header marks a page that was never written.
+	// Compressed files start with a page map holding the never written first page.
+	bool compressed = (format != NULL && format->compressed);
+	size_t headerSize = (format != NULL) ? SM_FILE_HEADER_SIZE : 0;
+	size_t pageHeaderSize = (format != NULL && format->checksums) ? sizeof(SM_PageHeader) : 0;
+	size_t fileSize = headerSize + (compressed ? sizeof(SM_PageLocation) : pageHeaderSize + pageSize);
+
+	// Creating the file header and an empty page in memory.
+	char *fileContent = (char *)calloc(fileSize, sizeof(char));
+	if(format != NULL) {
+		SM_FileHeader *fileHeader = (SM_FileHeader *)fileContent;
+		memcpy(fileHeader->magic, SM_FILE_MAGIC, sizeof(fileHeader->magic));
+		fileHeader->version = SM_FILE_VERSION;
+		fileHeader->flags = (format->checksums ? SM_FILE_FLAG_CHECKSUMS : 0) | (compressed ? SM_FILE_FLAG_COMPRESSED : 0);
+		fileHeader->pageSize = pageSize;
+		if(compressed) {
+			fileHeader->mapOffset = SM_FILE_HEADER_SIZE;
+			fileHeader->mapPages = 1;
+			fileHeader->mapChecksum = crc32c(0, fileContent + SM_FILE_HEADER_SIZE, sizeof(SM_PageLocation));
+		}
 	}
-	
-	// Setting the current page position to the cursor(pointer) position of the file stream
-	fHandle->curPagePos = ftell(pageFile); 
 
-	// Closing file stream so that all the buffers are flushed.
-	fclose(pageFile);
-	return RC_OK;	
+	// Writing empty page to file.
+	RC result = writeFully(fd, fileContent, fileSize, 0);
+	if(result != RC_OK)
+		printf("write failed \n");
+	else
+		printf("write succeeded \n");
+
+	// De-allocating the memory previously allocated to 'fileContent' and closing the descriptor.
+	free(fileContent);
+	close(fd);
+	return result;
 }
 
-extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	// Checking if the pageNumber parameter is less than Total number of pages and less than 0, then return respective error code
-	if (pageNum > fHandle->totalNumPages || pageNum < 0)
-        	return RC_WRITE_FAILED;
-	
-	// Opening file stream in read & write mode. 'r+' mode opens the file for both reading and writing.	
-	pageFile = fopen(fHandle->fileName, "r+");
-	
+// Reads the file header, files without one keep the plain layout. 'numPages' is set for compressed files only.
+static RC readFileFormat(SM_FileInfo *info, off_t fileSize, int *numPages) {
+	info->dataOffset = 0;
+	info->pageSize = PAGE_SIZE;
+	info->pageStride = PAGE_SIZE;
+	info->checksums = false;
+	info->verifyChecksums = false;
+	info->compressed = false;
+	info->pageMap = NULL;
+	info->pageMapCapacity = 0;
+	info->dataEnd = 0;
+	if(fileSize < SM_FILE_HEADER_SIZE)
+		return RC_OK;
+
+	// The buffer is aligned so that the header can also be read through an O_DIRECT descriptor.
+	void *buffer = NULL;
+	if(posix_memalign(&buffer, SM_DIRECT_IO_ALIGNMENT, SM_FILE_HEADER_SIZE) != 0)
+		return RC_MELLOC_MEM_ALLOC_FAILED;
+	RC result = readFully(info->fd, (char *)buffer, SM_FILE_HEADER_SIZE, 0);
+	SM_FileHeader *fileHeader = (SM_FileHeader *)buffer;
+
+	if(result == RC_OK && memcmp(fileHeader->magic, SM_FILE_MAGIC, sizeof(fileHeader->magic)) == 0) {
+		if(fileHeader->version != SM_FILE_VERSION || fileHeader->pageSize > SM_MAX_PAGE_SIZE || fileHeader->pageSize % SM_MIN_PAGE_SIZE != 0) {
+			result = RC_FILE_FORMAT_NOT_SUPPORTED;
+		} else {
+			info->dataOffset = SM_FILE_HEADER_SIZE;
+			if(fileHeader->pageSize != 0)
+				info->pageSize = fileHeader->pageSize;
+			info->pageStride = info->pageSize;
+			info->checksums = (fileHeader->flags & SM_FILE_FLAG_CHECKSUMS) != 0;
+			info->verifyChecksums = info->checksums;
+			info->compressed = (fileHeader->flags & SM_FILE_FLAG_COMPRESSED) != 0;
+			if(info->checksums)
+				info->pageStride = sizeof(SM_PageHeader) + info->pageSize;
+			if(info->compressed && numPages != NULL)
+				result = loadPageMap(info, fileHeader, fileSize, numPages);
+		}
+	}
+	free(buffer);
+	return result;
+}
+
+extern RC openPageFile (char *fileName, SM_FileHandle *fHandle) {
+	// Existing callers keep the descriptor based backend.
+	return openPageFileWithMode(fileName, fHandle, SM_IO_PREAD);
+}
+
+extern RC openPageFileWithMode (char *fileName, SM_FileHandle *fHandle, SM_IOMode mode) {
+	// Opening the file for reading and writing. The descriptor is kept until closePageFile.
+	int flags = (mode == SM_IO_MMAP_READ_ONLY) ? O_RDONLY : O_RDWR;
+	if(mode == SM_IO_DIRECT)
+		flags |= O_DIRECT;
+	int fd = open(fileName, flags);
+
 	// Checking if file was successfully opened.
-	if(pageFile == NULL)
+	if(fd < 0)
 		return RC_FILE_NOT_FOUND;
 
-	int startPosition = pageNum * PAGE_SIZE;
-
-	if(pageNum == 0) { 
-		//Writing data to non-first page
-		fseek(pageFile, startPosition, SEEK_SET);	
-		int i;
-		for(i = 0; i < PAGE_SIZE; i++) 
-		{
-			// Checking if it is end of file. If yes then append an enpty block.
-			if(feof(pageFile)) // check file is ending in between writing
-				 appendEmptyBlock(fHandle);
-			// Writing a character from memPage to page file			
-			fputc(memPage[i], pageFile);
-		}
+	/* Using fstat() to get the file total size.
+	   fstat() is a system call that is used to determine information about a file based on its file descriptor.
+	   'st_size' member variable of the 'stat' structure gives the total size of the file in bytes.
+	*/
+	struct stat fileInfo;
+	if(fstat(fd, &fileInfo) < 0) {
+		close(fd);
+		return RC_ERROR;
+	}
 
-		// Setting the current page position to the cursor(pointer) position of the file stream
-		fHandle->curPagePos = ftell(pageFile); 
+	SM_FileInfo *info = (SM_FileInfo *)malloc(sizeof(SM_FileInfo));
+	info->fd = fd;
+	info->ioMode = mode;
+	info->mapAddress = NULL;
+	info->mapSize = 0;
 
-		// Closing file stream so that all the buffers are flushed.
-		fclose(pageFile);	
-	} else {	
-		// Writing data to the first page.
-		fHandle->curPagePos = startPosition;
-		fclose(pageFile);
-		writeCurrentBlock(fHandle, memPage);
+	// Checksummed and compressed pages are not aligned in the file and are not contiguous, they can neither be
+	// mapped nor transferred with O_DIRECT. The map of a compressed file is only loaded for a writable handle.
+	int compressedPages = 0;
+	RC result = RC_OK;
+	if(mode != SM_IO_PREAD) {
+		result = readFileFormat(info, fileInfo.st_size, NULL);
+		if(result == RC_OK && (info->checksums || info->compressed))
+			result = RC_FILE_FORMAT_NOT_SUPPORTED;
+		// O_DIRECT transfers whole pages, which only works for pages that are a multiple of the alignment
+		if(result == RC_OK && mode == SM_IO_DIRECT && info->pageSize % SM_DIRECT_IO_ALIGNMENT != 0)
+			result = RC_FILE_FORMAT_NOT_SUPPORTED;
+	} else {
+		result = readFileFormat(info, fileInfo.st_size, &compressedPages);
 	}
+	if(result != RC_OK) {
+		close(fd);
+		free(info->pageMap);
+		free(info);
+		return result;
+	}
+
+	info->growthExtent = SM_DEFAULT_GROWTH_EXTENT;
+	info->canPreallocate = true;
+
+	// Space reserved by an earlier handle stays allocated behind the end of the file, st_blocks counts it (in 512 byte units).
+	info->allocatedPages = pagesInFile(info, fileInfo.st_size);
+	if(pagesInFile(info, (off_t)fileInfo.st_blocks * 512) > info->allocatedPages)
+		info->allocatedPages = pagesInFile(info, (off_t)fileInfo.st_blocks * 512);
+
+	// Mapping all complete pages of the file for the memory mapped backend.
+	if(isMapped(info) && mapFile(info, pagesInFile(info, fileInfo.st_size)) != RC_OK) {
+		close(fd);
+		free(info);
+		return RC_ERROR;
+	}
+
+	// Updating file handle's filename and set the current position to the first page.
+	fHandle->fileName = fileName;
+	fHandle->curPagePos = 0;
+	fHandle->totalNumPages = info->compressed ? compressedPages : pagesInFile(info, fileInfo.st_size);
+	fHandle->pageSize = info->pageSize;
+	fHandle->mgmtInfo = info;
 	return RC_OK;
 }
 
-extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
-	// Opening file stream in read & write mode. 'r+' mode opens the file for both reading and writing.	
-	pageFile = fopen(fHandle->fileName, "r+");
+extern RC setGrowthExtent (SM_FileHandle *fHandle, int extentPages) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+	if(extentPages < 0)
+		return RC_ERROR;
 
-	// Checking if file was successfully opened.
-	if(pageFile == NULL)
+	info->growthExtent = extentPages;
+	return RC_OK;
+}
+
+extern RC setChecksumVerification (SM_FileHandle *fHandle, bool verify) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+	if(!info->checksums)
+		return RC_FILE_FORMAT_NOT_SUPPORTED;
+
+	// Pages are still checksummed when they are written, only the check on reads is skipped.
+	info->verifyChecksums = verify;
+	return RC_OK;
+}
+
+extern RC closePageFile (SM_FileHandle *fHandle) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+
+	// Checking if the file handle was opened before.
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Compressed files keep their page map at the end of the file while they are closed.
+	RC result = RC_OK;
+	if(info->compressed)
+		result = storePageMap(info, fHandle->totalNumPages);
+
+	// Releasing the mapping, the descriptor and the book-keeping of the handle.
+	if(info->mapAddress != NULL)
+		munmap(info->mapAddress, info->mapSize);
+	close(info->fd);
+	free(info->pageMap);
+	free(info);
+	fHandle->mgmtInfo = NULL;
+	return result;
+}
+
+
+extern RC destroyPageFile (char *fileName) {
+	// Deleting the given filename so that it is no longer accessible.
+	if(remove(fileName) != 0)
 		return RC_FILE_NOT_FOUND;
-	
-	// Appending an empty block to make some space for the new content.
-	appendEmptyBlock(fHandle);
-
-	// Initiliazing file pointer
-	fseek(pageFile, fHandle->curPagePos, SEEK_SET);
-	
-	// Writing memPage contents to the file.
-	fwrite(memPage, sizeof(char), strlen(memPage), pageFile);
-	
-	// Setting the current page position to the cursor(pointer) position of the file stream
-	fHandle->curPagePos = ftell(pageFile);
-
-	// Closing file stream so that all the buffers are flushed.     	
-	fclose(pageFile);
 	return RC_OK;
 }
 
+// ***** READ FUNCTIONS ***** //
 
-extern RC appendEmptyBlock (SM_FileHandle *fHandle) {
-	// Creating an empty page of size PAGE_SIZE bytes
-	SM_PageHandle emptyBlock = (SM_PageHandle)calloc(PAGE_SIZE, sizeof(char));
-	
-	// Moving the cursor (pointer) position to the begining of the file stream.
-	// And the seek is success if fseek() return 0
-	int isSeekSuccess = fseek(pageFile, 0, SEEK_END);
-	
-	if( isSeekSuccess == 0 ) {
-		// Writing an empty page to the file
-		fwrite(emptyBlock, sizeof(char), PAGE_SIZE, pageFile);
+// Reads 'count' adjacent pages of a checksummed file. The page headers are gathered into 'headers' and the pages
+// into memPages[i] with a single preadv, then every page is verified unless verification is turned off.
+static RC readChecksummedPages(SM_FileInfo *info, int startPage, int count, SM_PageHeader *headers, SM_PageHandle *memPages) {
+	struct iovec *iov = (struct iovec *)malloc(sizeof(struct iovec) * 2 * count);
+	int iter;
+	for(iter = 0; iter < count; iter++) {
+		iov[2 * iter].iov_base = &headers[iter];
+		iov[2 * iter].iov_len = sizeof(SM_PageHeader);
+		iov[2 * iter + 1].iov_base = memPages[iter];
+		iov[2 * iter + 1].iov_len = info->pageSize;
+	}
+	RC result = transferVectorFully(info->fd, iov, 2 * count, pageOffset(info, startPage), false);
+	free(iov);
+
+	for(iter = 0; iter < count && result == RC_OK && info->verifyChecksums; iter++)
+		result = verifyPage(startPage + iter, &headers[iter], memPages[iter], info->pageSize);
+	return result;
+}
+
+extern RC readBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Checking if the pageNumber parameter is within the file, else return respective error code
+	if (pageNum >= fHandle->totalNumPages || pageNum < 0)
+		return RC_READ_NON_EXISTING_PAGE;
+	if(!isTransferAllowed(info, memPage))
+		return RC_BUFFER_NOT_ALIGNED;
+
+	RC result = RC_OK;
+	if(isMapped(info)) {
+		// The page is already in memory, we only copy it out of the mapping.
+		memcpy(memPage, info->mapAddress + pageOffset(info, pageNum), info->pageSize);
+	} else if(info->compressed) {
+		result = readCompressedPage(info, pageNum, memPage);
+	} else if(info->checksums) {
+		// Reading the page header together with the page and checking the page against its checksum
+		SM_PageHeader header;
+		result = readChecksummedPages(info, pageNum, 1, &header, &memPage);
+	} else {
+		// Reading the whole block with one positional read. Position is calculated by Page Number x Page Size
+		result = readFully(info->fd, memPage, info->pageSize, pageOffset(info, pageNum));
+	}
+	if(result != RC_OK)
+		return result;
+
+	// Setting the current page position to the page we just read
+	fHandle->curPagePos = pageNum;
+	return RC_OK;
+}
+
+extern RC readBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle memPages) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// All pages of the run have to exist in the file
+	if (startPage < 0 || count <= 0 || startPage > fHandle->totalNumPages - count)
+		return RC_READ_NON_EXISTING_PAGE;
+	if(!isTransferAllowed(info, memPages))
+		return RC_BUFFER_NOT_ALIGNED;
+
+	RC result = RC_OK;
+	size_t length = (size_t)count * info->pageSize;
+	if(isMapped(info)) {
+		memcpy(memPages, info->mapAddress + pageOffset(info, startPage), length);
+	} else if(info->compressed) {
+		// Every page of a compressed file is a record of its own
+		int iter;
+		for(iter = 0; iter < count && result == RC_OK; iter++)
+			result = readCompressedPage(info, startPage + iter, memPages + (size_t)iter * info->pageSize);
+	} else if(info->checksums) {
+		// The page headers sit between the pages in the file, they are read into a separate array
+		SM_PageHeader *headers = (SM_PageHeader *)malloc(sizeof(SM_PageHeader) * count);
+		SM_PageHandle *pages = (SM_PageHandle *)malloc(sizeof(SM_PageHandle) * count);
+		int iter;
+		for(iter = 0; iter < count; iter++)
+			pages[iter] = memPages + (size_t)iter * info->pageSize;
+		result = readChecksummedPages(info, startPage, count, headers, pages);
+		free(pages);
+		free(headers);
+	} else {
+		// The pages are adjacent in the file and in memory, a single positional read transfers all of them
+		result = readFully(info->fd, memPages, length, pageOffset(info, startPage));
+	}
+	if(result != RC_OK)
+		return result;
+
+	// Setting the current page position to the last page we read
+	fHandle->curPagePos = startPage + count - 1;
+	return RC_OK;
+}
+
+extern RC readPageHeader (int pageNum, SM_FileHandle *fHandle, SM_PageHeader *header) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Only checksummed files store a header in front of their pages, compressed files keep a record header instead
+	if(!info->checksums || info->compressed)
+		return RC_FILE_FORMAT_NOT_SUPPORTED;
+	if (pageNum >= fHandle->totalNumPages || pageNum < 0)
+		return RC_READ_NON_EXISTING_PAGE;
+
+	return readFully(info->fd, (char *)header, sizeof(SM_PageHeader), pageOffset(info, pageNum));
+}
+
+extern RC getBlockAddress (int pageNum, SM_FileHandle *fHandle, SM_PageHandle *address) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Only memory mapped handles have an address for a page.
+	if(!isMapped(info))
+		return RC_ERROR;
+
+	if (pageNum >= fHandle->totalNumPages || pageNum < 0)
+		return RC_READ_NON_EXISTING_PAGE;
+
+	*address = info->mapAddress + pageOffset(info, pageNum);
+	return RC_OK;
+}
+
+extern RC getBlockLocation (int pageNum, SM_FileHandle *fHandle, int *fd, long long *offset) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Memory mapped files have to be accessed through the mapping to stay coherent with it,
+	// checksummed and compressed pages have to be checked and written together with their header.
+	if(isMapped(info) || info->checksums || info->compressed)
+		return RC_ERROR;
+
+	if (pageNum >= fHandle->totalNumPages || pageNum < 0)
+		return RC_READ_NON_EXISTING_PAGE;
+
+	*fd = info->fd;
+	*offset = (long long)pageOffset(info, pageNum);
+	return RC_OK;
+}
+
+extern int getBlockPos (SM_FileHandle *fHandle) {
+	// Returning the current page position retrieved from the file handle
+	return fHandle->curPagePos;
+}
+
+extern RC readFirstBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	// The first block is always page 0
+	return readBlock(0, fHandle, memPage);
+}
+
+extern RC readPreviousBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	// readBlock rejects page -1, so reading before the first block returns RC_READ_NON_EXISTING_PAGE
+	return readBlock(fHandle->curPagePos - 1, fHandle, memPage);
+}
+
+extern RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	return readBlock(fHandle->curPagePos, fHandle, memPage);
+}
+
+extern RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage){
+	// readBlock rejects pages past the end, so reading after the last block returns RC_READ_NON_EXISTING_PAGE
+	return readBlock(fHandle->curPagePos + 1, fHandle, memPage);
+}
+
+extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage){
+	return readBlock(fHandle->totalNumPages - 1, fHandle, memPage);
+}
+
+// ***** WRITE FUNCTIONS ***** //
+
+// Writes 'count' adjacent pages, memPages[i] holds page startPage + i. Checksummed files get a header in front
+// of every page, the headers and pages are gathered into one vector. 'header' supplies the page type and LSN of a single page.
+static RC writePages(SM_FileInfo *info, SM_FileHandle *fHandle, int startPage, int count, SM_PageHandle *memPages, const SM_PageHeader *header) {
+	int iter;
+	if(info->ioMode == SM_IO_MMAP) {
+		// Growing the file and the mapping once for all pages behind the end
+		RC result = growFile(info, fHandle, startPage + count);
+		if(result != RC_OK)
+			return result;
+		for(iter = 0; iter < count; iter++)
+			memcpy(info->mapAddress + pageOffset(info, startPage + iter), memPages[iter], info->pageSize);
+		return RC_OK;
+	}
+
+	if(info->compressed) {
+		// Making room in the page map for pages written behind the end, then compressing page by page
+		RC result = growFile(info, fHandle, startPage + count);
+		for(iter = 0; iter < count && result == RC_OK; iter++)
+			result = writeCompressedPage(info, startPage + iter, memPages[iter]);
+		return result;
+	}
+
+	// Writing directly after the last page extends the file, its space is reserved a whole extent at a time.
+	if(startPage + count > fHandle->totalNumPages)
+		reserveSpace(info, startPage + count);
+
+	RC result;
+	if(count == 1 && !info->checksums) {
+		// Writing the whole block with one positional write.
+		result = writeFully(info->fd, memPages[0], info->pageSize, pageOffset(info, startPage));
 	} else {
-		free(emptyBlock);
+		// Gathering the page buffers (and page headers) into one vector, so the whole run is written with one pwritev
+		int buffersPerPage = info->checksums ? 2 : 1;
+		struct iovec *iov = (struct iovec *)malloc(sizeof(struct iovec) * buffersPerPage * count);
+		SM_PageHeader *headers = info->checksums ? (SM_PageHeader *)malloc(sizeof(SM_PageHeader) * count) : NULL;
+		int iovCount = 0;
+		for(iter = 0; iter < count; iter++) {
+			if(info->checksums) {
+				preparePageHeader(startPage + iter, &headers[iter], header, memPages[iter], info->pageSize);
+				iov[iovCount].iov_base = &headers[iter];
+				iov[iovCount].iov_len = sizeof(SM_PageHeader);
+				iovCount++;
+			}
+			iov[iovCount].iov_base = memPages[iter];
+			iov[iovCount].iov_len = info->pageSize;
+			iovCount++;
+		}
+		result = transferVectorFully(info->fd, iov, iovCount, pageOffset(info, startPage), true);
+		free(headers);
+		free(iov);
+	}
+	if(result != RC_OK)
+		return result;
+
+	// Pages written behind the last page append to the file
+	if(startPage + count > fHandle->totalNumPages)
+		fHandle->totalNumPages = startPage + count;
+	return RC_OK;
+}
+
+extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	// Plain data page without an LSN
+	return writeBlockWithHeader(pageNum, fHandle, memPage, NULL);
+}
+
+extern RC writeBlockWithHeader (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, const SM_PageHeader *header) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Checking if the pageNumber parameter is within the file or directly after its end, else return respective error code
+	if (pageNum > fHandle->totalNumPages || pageNum < 0 || info->ioMode == SM_IO_MMAP_READ_ONLY)
 		return RC_WRITE_FAILED;
+	if(!isTransferAllowed(info, memPage))
+		return RC_BUFFER_NOT_ALIGNED;
+
+	RC result = writePages(info, fHandle, pageNum, 1, &memPage, header);
+	if(result != RC_OK)
+		return result;
+
+	// Setting the current page position to the page we just wrote
+	fHandle->curPagePos = pageNum;
+	return RC_OK;
+}
+
+extern RC writeBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// The run has to start within the file or directly after its end, like for writeBlock
+	if (startPage < 0 || count <= 0 || startPage > fHandle->totalNumPages || info->ioMode == SM_IO_MMAP_READ_ONLY)
+		return RC_WRITE_FAILED;
+
+	int iter;
+	for(iter = 0; iter < count; iter++) {
+		if(!isTransferAllowed(info, memPages[iter]))
+			return RC_BUFFER_NOT_ALIGNED;
 	}
-	
-	// De-allocating the memory previously allocated to 'emptyPage'.
-	// This is optional but always better to do for proper memory management.
-	free(emptyBlock);
-	
-	// Incrementing the total number of pages since we added an empty black.
-	fHandle->totalNumPages++;
+
+	RC result = writePages(info, fHandle, startPage, count, memPages, NULL);
+	if(result != RC_OK)
+		return result;
+
+	// Setting the current page position to the last page we wrote
+	fHandle->curPagePos = startPage + count - 1;
 	return RC_OK;
 }
 
+extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage) {
+	return writeBlock(fHandle->curPagePos, fHandle, memPage);
+}
+
+
+extern RC appendEmptyBlock (SM_FileHandle *fHandle) {
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Adding one empty page after the last page of the file
+	return growFile(info, fHandle, fHandle->totalNumPages + 1);
+}
+
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle) {
-	// Opening file stream in append mode. 'a' mode opens the file to append the data at the end of file.
-	pageFile = fopen(fHandle->fileName, "a");
-	
-	if(pageFile == NULL)
-		return RC_FILE_NOT_FOUND;
-	
-	// Checking if numberOfPages is greater than totalNumPages.
-	// If that is the case, then add empty pages till numberofPages = totalNumPages
-	while(numberOfPages > fHandle->totalNumPages)
-		appendEmptyBlock(fHandle);
-	
-	// Closing file stream so that all the buffers are flushed. 
-	fclose(pageFile);
-	return RC_OK;
-}
\ No newline at end of file
+	SM_FileInfo *info = getFileInfo(fHandle);
+	if(info == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// If numberOfPages is greater than totalNumPages, empty pages are added till numberofPages = totalNumPages.
+	// Growing in one step lets the memory mapped backend remap only once.
+	return growFile(info, fHandle, numberOfPages);
+}
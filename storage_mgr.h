@@ -2,6 +2,8 @@
 #define STORAGE_MGR_H
 
 #include "dberror.h"
+#include "dt.h"
+#include <stdint.h>
 
 /************************************************************
  *                    handle data structures                *
@@ -10,18 +12,63 @@ typedef struct SM_FileHandle {
   char *fileName;
   int totalNumPages;
   int curPagePos;
+  int pageSize; // size of the pages of the file in bytes, set by openPageFile
   void *mgmtInfo;
 } SM_FileHandle;
 
 typedef char* SM_PageHandle;
 
+// I/O backends a page file can be opened with
+typedef enum SM_IOMode {
+  SM_IO_PREAD = 0,  // positional reads and writes through the file descriptor
+  SM_IO_MMAP = 1,   // whole file mapped into memory, blocks are copied from and to the mapping
+  SM_IO_MMAP_READ_ONLY = 2, // read-only mapping, writes and file growth are rejected
+  SM_IO_DIRECT = 3  // O_DIRECT, bypasses the kernel page cache; page buffers must be SM_DIRECT_IO_ALIGNMENT aligned
+} SM_IOMode;
+
+// alignment of page buffers passed to a file opened with SM_IO_DIRECT
+#define SM_DIRECT_IO_ALIGNMENT 4096
+
+// file growth: space is reserved in extents of this many pages (256 pages = 1 MB),
+// SM_GROWTH_GEOMETRIC doubles the reserved space instead
+#define SM_DEFAULT_GROWTH_EXTENT 256
+#define SM_GROWTH_GEOMETRIC 0
+
+// Page files created with createPageFileWithFormat start with a file header of this size
+#define SM_FILE_HEADER_SIZE 4096
+
+// limits of the page size of a page file, the page size has to be a multiple of SM_MIN_PAGE_SIZE
+#define SM_MIN_PAGE_SIZE 512
+#define SM_MAX_PAGE_SIZE (1024 * 1024)
+
+// Options for the on-disk format of a new page file
+typedef struct SM_FileFormat {
+  bool checksums; // every page is stored with an SM_PageHeader and checked with CRC32C when it is read
+  bool compressed; // pages are stored compressed, located through a page map kept at the end of the file
+  int pageSize;    // size of the pages in bytes, 0 for PAGE_SIZE
+} SM_FileFormat;
+
+// Header stored in front of every page of a checksummed file
+typedef struct SM_PageHeader {
+  uint32_t checksum; // CRC32C of the page number, the rest of the header and the page; 0 for a page never written
+  uint32_t pageType;
+  uint64_t lsn;      // log sequence number or version of the page, supplied by the writer
+} SM_PageHeader;
+
+#define SM_PAGE_TYPE_FREE 0
+#define SM_PAGE_TYPE_DATA 1
+
 /************************************************************
  *                    interface                             *
  ************************************************************/
 /* manipulating page files */
 extern void initStorageManager (void);
 extern RC createPageFile (char *fileName);
+extern RC createPageFileWithFormat (char *fileName, const SM_FileFormat *format);
 extern RC openPageFile (char *fileName, SM_FileHandle *fHandle);
+extern RC openPageFileWithMode (char *fileName, SM_FileHandle *fHandle, SM_IOMode mode);
+extern RC setGrowthExtent (SM_FileHandle *fHandle, int extentPages);
+extern RC setChecksumVerification (SM_FileHandle *fHandle, bool verify);
 extern RC closePageFile (SM_FileHandle *fHandle);
 extern RC destroyPageFile (char *fileName);
 
@@ -34,8 +81,26 @@ extern RC readCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readNextBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC readLastBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 
+/* reading 'count' adjacent pages into one buffer of count * pageSize bytes */
+extern RC readBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle memPages);
+
+/* page header of a checksummed file, fails for files without page headers */
+extern RC readPageHeader (int pageNum, SM_FileHandle *fHandle, SM_PageHeader *header);
+
+/* direct access to the mapping of a memory mapped file; the address stays
+   valid until the file grows or the handle is closed */
+extern RC getBlockAddress (int pageNum, SM_FileHandle *fHandle, SM_PageHandle *address);
+
+/* descriptor and byte offset of an existing page for I/O engines that transfer pages
+   themselves; fails for files whose blocks must go through readBlock/writeBlock */
+extern RC getBlockLocation (int pageNum, SM_FileHandle *fHandle, int *fd, long long *offset);
+
 /* writing blocks to a page file */
 extern RC writeBlock (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage);
+/* like writeBlock, the page type and LSN of 'header' are stored in the page header of a checksummed file */
+extern RC writeBlockWithHeader (int pageNum, SM_FileHandle *fHandle, SM_PageHandle memPage, const SM_PageHeader *header);
+/* writing 'count' adjacent pages, memPages[i] holds page startPage + i (scatter/gather) */
+extern RC writeBlocks (int startPage, int count, SM_FileHandle *fHandle, SM_PageHandle *memPages);
 extern RC writeCurrentBlock (SM_FileHandle *fHandle, SM_PageHandle memPage);
 extern RC appendEmptyBlock (SM_FileHandle *fHandle);
 extern RC ensureCapacity (int numberOfPages, SM_FileHandle *fHandle);
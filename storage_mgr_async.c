@@ -0,0 +1,500 @@
+#define _GNU_SOURCE
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+#include<errno.h>
+#include<unistd.h>
+#include<pthread.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<linux/io_uring.h>
+
+#include "storage_mgr_async.h"
+#include "dt.h"
+
+// Queue depth used when the caller does not ask for one
+#define DEFAULT_QUEUE_DEPTH 64
+
+// Number of workers of the thread pool engine
+#define ASYNC_IO_WORKERS 4
+
+// Mapped submission and completion rings of an io_uring instance
+typedef struct URing {
+	int ringFd;
+	unsigned sqEntries;
+	unsigned cqEntries;
+	unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+	unsigned *cqHead, *cqTail, *cqMask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sqRing, *cqRing;
+	size_t sqRingSize, cqRingSize, sqesSize;
+} URing;
+
+// The lock guards the counters and queues, it is never held while a transfer runs or a thread sleeps in the kernel.
+// 'queued' wakes the workers (or the reaper) up when requests were submitted, 'completed' wakes the waiters up.
+struct SM_AsyncContext {
+	SM_AsyncEngine engine;
+	pthread_mutex_t lock;
+	pthread_cond_t queued;
+	pthread_cond_t completed;
+	bool shuttingDown;
+	// number of submitted requests that are not done yet
+	int inFlight;
+
+	// io_uring engine: the reaper thread is the only one that waits for and consumes completions
+	URing ring;
+	pthread_t reaper;
+
+	// thread pool engine
+	SM_AsyncRequest *queueHead, *queueTail;
+	pthread_t workers[ASYNC_IO_WORKERS];
+	int numWorkers;
+};
+
+// ***** HELPER FUNCTIONS ***** //
+
+// Publishes the outcome of a request. Waiters may check 'done' without holding any lock.
+static void markDone(SM_AsyncRequest *request, RC result) {
+	request->result = result;
+	__atomic_store_n(&request->done, 1, __ATOMIC_RELEASE);
+}
+
+static bool isDone(SM_AsyncRequest *request) {
+	return __atomic_load_n(&request->done, __ATOMIC_ACQUIRE) != 0;
+}
+
+// Transfers the part of the page starting at 'transferred' with plain positional I/O.
+// Used by the worker threads and to finish short transfers of the ring.
+static RC transferPage(SM_AsyncRequest *request, size_t transferred) {
+	while(transferred < (size_t)request->length) {
+		ssize_t result;
+		if(request->op == SM_ASYNC_READ)
+			result = pread(request->fd, request->memPage + transferred, request->length - transferred, request->offset + transferred);
+		else
+			result = pwrite(request->fd, request->memPage + transferred, request->length - transferred, request->offset + transferred);
+
+		if(result < 0 && errno == EINTR)
+			continue;
+		if(result == 0 && request->op == SM_ASYNC_READ)
+			return RC_READ_NON_EXISTING_PAGE;
+		if(result <= 0)
+			return (request->op == SM_ASYNC_READ) ? RC_ERROR : RC_WRITE_FAILED;
+		transferred += result;
+	}
+	return RC_OK;
+}
+
+// ***** IO_URING ENGINE ***** //
+
+static int ringEnter(URing *ring, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+	return (int)syscall(__NR_io_uring_enter, ring->ringFd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static void teardownRing(URing *ring) {
+	if(ring->sqes != NULL && ring->sqes != MAP_FAILED)
+		munmap(ring->sqes, ring->sqesSize);
+	if(ring->cqRing != NULL && ring->cqRing != MAP_FAILED && ring->cqRing != ring->sqRing)
+		munmap(ring->cqRing, ring->cqRingSize);
+	if(ring->sqRing != NULL && ring->sqRing != MAP_FAILED)
+		munmap(ring->sqRing, ring->sqRingSize);
+	close(ring->ringFd);
+}
+
+// Creates the ring and maps its queues. Fails on kernels without io_uring or without IORING_OP_READ/WRITE.
+static RC setupRing(URing *ring, unsigned entries) {
+	struct io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	memset(ring, 0, sizeof(URing));
+
+	ring->ringFd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if(ring->ringFd < 0)
+		return RC_ERROR;
+
+	// IORING_OP_READ and IORING_OP_WRITE arrived in the same release (5.6) as this feature flag.
+	if(!(params.features & IORING_FEAT_CUR_PERSONALITY)) {
+		close(ring->ringFd);
+		return RC_ERROR;
+	}
+
+	ring->sqEntries = params.sq_entries;
+	ring->cqEntries = params.cq_entries;
+	ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	// Newer kernels share one mapping for both rings.
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if(singleMap) {
+		if(ring->cqRingSize > ring->sqRingSize)
+			ring->sqRingSize = ring->cqRingSize;
+		ring->cqRingSize = ring->sqRingSize;
+	}
+
+	ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_SQ_RING);
+	if(ring->sqRing == MAP_FAILED) {
+		teardownRing(ring);
+		return RC_ERROR;
+	}
+	if(singleMap)
+		ring->cqRing = ring->sqRing;
+	else
+		ring->cqRing = mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_CQ_RING);
+	ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ringFd, IORING_OFF_SQES);
+	if(ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED) {
+		teardownRing(ring);
+		return RC_ERROR;
+	}
+
+	char *sq = (char *)ring->sqRing;
+	char *cq = (char *)ring->cqRing;
+	ring->sqHead = (unsigned *)(sq + params.sq_off.head);
+	ring->sqTail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sqArray = (unsigned *)(sq + params.sq_off.array);
+	ring->cqHead = (unsigned *)(cq + params.cq_off.head);
+	ring->cqTail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	return RC_OK;
+}
+
+// Completes the requests of the completion queue up to 'tail' and returns their number. Only called by the reaper,
+// which owns the head of the completion queue, so the context lock is not needed.
+static int reapRing(SM_AsyncContext *context, unsigned tail) {
+	URing *ring = &context->ring;
+	unsigned head = *ring->cqHead;
+	int reaped = 0;
+
+	while(head != tail) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cqMask];
+		SM_AsyncRequest *request = (SM_AsyncRequest *)(uintptr_t)cqe->user_data;
+
+		if(cqe->res < 0)
+			markDone(request, (request->op == SM_ASYNC_READ) ? RC_ERROR : RC_WRITE_FAILED);
+		else if(cqe->res == 0 && request->op == SM_ASYNC_READ)
+			markDone(request, RC_READ_NON_EXISTING_PAGE);
+		else
+			// A short transfer is finished synchronously
+			markDone(request, transferPage(request, (size_t)cqe->res));
+
+		head++;
+		reaped++;
+	}
+	__atomic_store_n(ring->cqHead, head, __ATOMIC_RELEASE);
+	return reaped;
+}
+
+// Reaper of the io_uring engine: sleeps in the kernel until requests complete, completes them and wakes the waiters up.
+// The context lock is only taken to update the counters, so submitters and waiters are never held up by the kernel.
+static void *ringReaper(void *argument) {
+	SM_AsyncContext *context = (SM_AsyncContext *)argument;
+	URing *ring = &context->ring;
+
+	pthread_mutex_lock(&context->lock);
+	while(true) {
+		while(context->inFlight == 0 && !context->shuttingDown)
+			pthread_cond_wait(&context->queued, &context->lock);
+
+		// Shutting down, and every submitted request has completed.
+		if(context->inFlight == 0)
+			break;
+		pthread_mutex_unlock(&context->lock);
+
+		if(*ring->cqHead == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+			ringEnter(ring, 0, 1, IORING_ENTER_GETEVENTS);
+
+		// Requests are submitted with the lock held, so taking it orders the completions seen now after the
+		// submissions that filled in their requests.
+		pthread_mutex_lock(&context->lock);
+		unsigned tail = __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE);
+		pthread_mutex_unlock(&context->lock);
+		int reaped = reapRing(context, tail);
+
+		pthread_mutex_lock(&context->lock);
+		if(reaped > 0) {
+			context->inFlight -= reaped;
+			pthread_cond_broadcast(&context->completed);
+		}
+	}
+	pthread_mutex_unlock(&context->lock);
+	return NULL;
+}
+
+// Places one request in the submission queue. The caller made sure there is room for it.
+static void queueRingRequest(URing *ring, SM_AsyncRequest *request) {
+	unsigned tail = *ring->sqTail;
+	unsigned index = tail & *ring->sqMask;
+	struct io_uring_sqe *sqe = &ring->sqes[index];
+
+	memset(sqe, 0, sizeof(struct io_uring_sqe));
+	sqe->opcode = (request->op == SM_ASYNC_READ) ? IORING_OP_READ : IORING_OP_WRITE;
+	sqe->fd = request->fd;
+	sqe->off = (unsigned long long)request->offset;
+	sqe->addr = (unsigned long long)(uintptr_t)request->memPage;
+	sqe->len = request->length;
+	sqe->user_data = (unsigned long long)(uintptr_t)request;
+
+	ring->sqArray[index] = index;
+	__atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Hands the last *count queued entries to the kernel without waiting for any of them. Called with the context lock held.
+// On failure *count is the number of entries the kernel did not take, they are still at the end of the queue.
+static RC submitRing(SM_AsyncContext *context, unsigned *count) {
+	while(*count > 0) {
+		int submitted = ringEnter(&context->ring, *count, 0, 0);
+		if(submitted < 0) {
+			if(errno == EINTR)
+				continue;
+			// The kernel is short of resources, make room by letting the reaper complete requests first.
+			if((errno == EAGAIN || errno == EBUSY) && context->inFlight > 0) {
+				pthread_cond_wait(&context->completed, &context->lock);
+				continue;
+			}
+			return RC_ERROR;
+		}
+		context->inFlight += submitted;
+		*count -= submitted;
+		pthread_cond_signal(&context->queued);
+	}
+	return RC_OK;
+}
+
+static RC submitRingBatch(SM_AsyncContext *context, SM_AsyncRequest **requests, int count) {
+	URing *ring = &context->ring;
+	int next = 0;
+
+	while(next < count) {
+		// Never have more requests in flight than the completion queue can hold.
+		unsigned room = ring->cqEntries - context->inFlight;
+		if(room > ring->sqEntries)
+			room = ring->sqEntries;
+		if(room == 0) {
+			pthread_cond_wait(&context->completed, &context->lock);
+			continue;
+		}
+
+		unsigned batch = 0;
+		while(batch < room && next < count) {
+			queueRingRequest(ring, requests[next++]);
+			batch++;
+		}
+
+		unsigned unsubmitted = batch;
+		RC result = submitRing(context, &unsubmitted);
+		if(result != RC_OK) {
+			// The entries the kernel did not take are taken back out of the queue, so that a later submission cannot
+			// hand them over once their requests are gone. They and the requests never queued fail right away.
+			__atomic_store_n(ring->sqTail, *ring->sqTail - unsubmitted, __ATOMIC_RELEASE);
+			for(next -= unsubmitted; next < count; next++)
+				markDone(requests[next], (requests[next]->op == SM_ASYNC_READ) ? RC_ERROR : RC_WRITE_FAILED);
+			return result;
+		}
+	}
+	return RC_OK;
+}
+
+// ***** THREAD POOL ENGINE ***** //
+
+static void *asyncWorker(void *argument) {
+	SM_AsyncContext *context = (SM_AsyncContext *)argument;
+
+	pthread_mutex_lock(&context->lock);
+	while(true) {
+		while(context->queueHead == NULL && !context->shuttingDown)
+			pthread_cond_wait(&context->queued, &context->lock);
+
+		// Shutting down, and every queued request has been served.
+		if(context->queueHead == NULL)
+			break;
+
+		SM_AsyncRequest *request = context->queueHead;
+		context->queueHead = request->next;
+		if(context->queueHead == NULL)
+			context->queueTail = NULL;
+
+		// The transfer itself runs without the lock so that the workers overlap.
+		pthread_mutex_unlock(&context->lock);
+		RC result = transferPage(request, 0);
+		pthread_mutex_lock(&context->lock);
+
+		markDone(request, result);
+		context->inFlight--;
+		pthread_cond_broadcast(&context->completed);
+	}
+	pthread_mutex_unlock(&context->lock);
+	return NULL;
+}
+
+static RC startRing(SM_AsyncContext *context, unsigned entries) {
+	RC result = setupRing(&context->ring, entries);
+	if(result != RC_OK)
+		return result;
+	if(pthread_create(&context->reaper, NULL, ringReaper, context) != 0) {
+		teardownRing(&context->ring);
+		return RC_ERROR;
+	}
+	return RC_OK;
+}
+
+static RC startWorkers(SM_AsyncContext *context) {
+	context->queueHead = context->queueTail = NULL;
+
+	for(context->numWorkers = 0; context->numWorkers < ASYNC_IO_WORKERS; context->numWorkers++) {
+		if(pthread_create(&context->workers[context->numWorkers], NULL, asyncWorker, context) != 0)
+			break;
+	}
+	return (context->numWorkers > 0) ? RC_OK : RC_ERROR;
+}
+
+// ***** ASYNC I/O INTERFACE ***** //
+
+extern RC initAsyncIO (SM_AsyncContext **context, int queueDepth) {
+	// Preferring io_uring, falling back to worker threads if the kernel does not offer it.
+	if(initAsyncIOWithEngine(context, queueDepth, SM_ASYNC_IO_URING) == RC_OK)
+		return RC_OK;
+	return initAsyncIOWithEngine(context, queueDepth, SM_ASYNC_THREAD_POOL);
+}
+
+extern RC initAsyncIOWithEngine (SM_AsyncContext **context, int queueDepth, SM_AsyncEngine engine) {
+	SM_AsyncContext *newContext = (SM_AsyncContext *)calloc(1, sizeof(SM_AsyncContext));
+	pthread_mutex_init(&newContext->lock, NULL);
+	pthread_cond_init(&newContext->queued, NULL);
+	pthread_cond_init(&newContext->completed, NULL);
+	newContext->shuttingDown = false;
+
+	if(queueDepth <= 0)
+		queueDepth = DEFAULT_QUEUE_DEPTH;
+
+	RC result = RC_ERROR;
+	if(engine == SM_ASYNC_IO_URING)
+		result = startRing(newContext, (unsigned)queueDepth);
+	else if(engine == SM_ASYNC_THREAD_POOL)
+		result = startWorkers(newContext);
+	if(result != RC_OK) {
+		pthread_cond_destroy(&newContext->queued);
+		pthread_cond_destroy(&newContext->completed);
+		pthread_mutex_destroy(&newContext->lock);
+		free(newContext);
+		return result;
+	}
+
+	newContext->engine = engine;
+	*context = newContext;
+	return RC_OK;
+}
+
+extern RC shutdownAsyncIO (SM_AsyncContext *context) {
+	if(context == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	// Requests still in flight reference caller memory, so they have to finish first.
+	waitAllAsyncIO(context);
+
+	pthread_mutex_lock(&context->lock);
+	context->shuttingDown = true;
+	pthread_cond_broadcast(&context->queued);
+	pthread_mutex_unlock(&context->lock);
+
+	if(context->engine == SM_ASYNC_IO_URING) {
+		pthread_join(context->reaper, NULL);
+		teardownRing(&context->ring);
+	} else {
+		int iter;
+		for(iter = 0; iter < context->numWorkers; iter++)
+			pthread_join(context->workers[iter], NULL);
+	}
+
+	pthread_cond_destroy(&context->queued);
+	pthread_cond_destroy(&context->completed);
+	pthread_mutex_destroy(&context->lock);
+	free(context);
+	return RC_OK;
+}
+
+extern SM_AsyncEngine getAsyncIOEngine (SM_AsyncContext *context) {
+	return context->engine;
+}
+
+extern RC submitAsyncIO (SM_AsyncContext *context, SM_FileHandle *fHandle, SM_AsyncRequest *requests, int count) {
+	if(context == NULL)
+		return RC_FILE_HANDLE_NOT_INIT;
+
+	SM_AsyncRequest **batch = (SM_AsyncRequest **)malloc(sizeof(SM_AsyncRequest *) * (count > 0 ? count : 1));
+	int batchSize = 0;
+	int iter;
+
+	for(iter = 0; iter < count; iter++) {
+		SM_AsyncRequest *request = &requests[iter];
+		request->done = 0;
+		request->next = NULL;
+
+		// Pages the engine cannot transfer itself (memory mapped files, pages behind the end of
+		// the file) are completed right away through the storage manager.
+		request->length = fHandle->pageSize;
+		if(getBlockLocation(request->pageNum, fHandle, &request->fd, &request->offset) != RC_OK) {
+			if(request->op == SM_ASYNC_READ)
+				markDone(request, readBlock(request->pageNum, fHandle, request->memPage));
+			else
+				markDone(request, writeBlock(request->pageNum, fHandle, request->memPage));
+			continue;
+		}
+		batch[batchSize++] = request;
+	}
+
+	RC result = RC_OK;
+	pthread_mutex_lock(&context->lock);
+	if(context->engine == SM_ASYNC_IO_URING) {
+		result = submitRingBatch(context, batch, batchSize);
+	} else {
+		for(iter = 0; iter < batchSize; iter++) {
+			if(context->queueTail == NULL)
+				context->queueHead = batch[iter];
+			else
+				context->queueTail->next = batch[iter];
+			context->queueTail = batch[iter];
+		}
+		context->inFlight += batchSize;
+		pthread_cond_broadcast(&context->queued);
+	}
+	pthread_mutex_unlock(&context->lock);
+
+	free(batch);
+	return result;
+}
+
+extern int pollAsyncIO (SM_AsyncContext *context) {
+	// Completions are consumed by the reaper or the workers, polling only looks at the count
+	pthread_mutex_lock(&context->lock);
+	int inFlight = context->inFlight;
+	pthread_mutex_unlock(&context->lock);
+	return inFlight;
+}
+
+extern RC waitAsyncIO (SM_AsyncContext *context, SM_AsyncRequest *request) {
+	if(isDone(request))
+		return request->result;
+
+	pthread_mutex_lock(&context->lock);
+	while(!isDone(request)) {
+		// Nothing in flight means the request was never submitted.
+		if(context->inFlight == 0) {
+			pthread_mutex_unlock(&context->lock);
+			return RC_ERROR;
+		}
+		pthread_cond_wait(&context->completed, &context->lock);
+	}
+	pthread_mutex_unlock(&context->lock);
+	return request->result;
+}
+
+extern RC waitAllAsyncIO (SM_AsyncContext *context) {
+	pthread_mutex_lock(&context->lock);
+	while(context->inFlight > 0)
+		pthread_cond_wait(&context->completed, &context->lock);
+	pthread_mutex_unlock(&context->lock);
+	return RC_OK;
+}
@@ -0,0 +1,58 @@
+#ifndef STORAGE_MGR_ASYNC_H
+#define STORAGE_MGR_ASYNC_H
+
+#include "dberror.h"
+#include "storage_mgr.h"
+
+/************************************************************
+ *                    handle data structures                *
+ ************************************************************/
+typedef enum SM_AsyncOp {
+  SM_ASYNC_READ = 0,
+  SM_ASYNC_WRITE = 1
+} SM_AsyncOp;
+
+// Engines that can execute asynchronous requests
+typedef enum SM_AsyncEngine {
+  SM_ASYNC_IO_URING = 0,    // kernel io_uring ring
+  SM_ASYNC_THREAD_POOL = 1  // small pool of worker threads doing pread/pwrite
+} SM_AsyncEngine;
+
+// A single page read or write. The request is owned by the caller and has to
+// stay valid (together with memPage) until it is done.
+typedef struct SM_AsyncRequest {
+  SM_AsyncOp op;
+  int pageNum;
+  SM_PageHandle memPage;
+  RC result;   // outcome of the request, valid once done is set
+  int done;
+
+  // filled in by submitAsyncIO
+  int fd;
+  long long offset;
+  int length;  // page size of the file
+  struct SM_AsyncRequest *next;
+} SM_AsyncRequest;
+
+typedef struct SM_AsyncContext SM_AsyncContext;
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* creating and destroying an I/O context */
+extern RC initAsyncIO (SM_AsyncContext **context, int queueDepth);
+/* like initAsyncIO, but only with the given engine; fails if the engine is not available */
+extern RC initAsyncIOWithEngine (SM_AsyncContext **context, int queueDepth, SM_AsyncEngine engine);
+extern RC shutdownAsyncIO (SM_AsyncContext *context);
+extern SM_AsyncEngine getAsyncIOEngine (SM_AsyncContext *context);
+
+/* submitting a batch of page reads or writes. Every request of the batch is done eventually, also if an error is
+   returned: the requests that could not be submitted are done with an error right away, the others complete as usual. */
+extern RC submitAsyncIO (SM_AsyncContext *context, SM_FileHandle *fHandle, SM_AsyncRequest *requests, int count);
+
+/* completion: poll returns the number of requests still in flight */
+extern int pollAsyncIO (SM_AsyncContext *context);
+extern RC waitAsyncIO (SM_AsyncContext *context, SM_AsyncRequest *request);
+extern RC waitAllAsyncIO (SM_AsyncContext *context);
+
+#endif
@@ -0,0 +1,164 @@
+#include<stdlib.h>
+#include<stdint.h>
+#include<string.h>
+
+#include "storage_mgr_compress.h"
+
+// A block is a sequence of runs. Every run starts with a token byte: the high 4 bits hold the number of
+// literal bytes, the low 4 bits the match length minus MIN_MATCH. A nibble of 15 is continued by extra bytes
+// that are added to it until a byte below 255. The literals follow, then the 2 byte offset of the match
+// (little endian). The last run only has literals and ends the block.
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define HASH_BITS 12
+
+// ***** HELPER FUNCTIONS ***** //
+
+static uint32_t readWord(const char *source) {
+	uint32_t word;
+	memcpy(&word, source, sizeof(word));
+	return word;
+}
+
+// Hash of the 4 bytes at the current position, used to find an earlier occurrence of them
+static int hashWord(uint32_t word) {
+	return (int)((word * 2654435761u) >> (32 - HASH_BITS));
+}
+
+// Writes a length that did not fit into its nibble. Returns the new output position or -1 if dest is full.
+static int writeLength(char *dest, int outPos, int destCapacity, int length) {
+	while(length >= 255) {
+		if(outPos >= destCapacity)
+			return -1;
+		dest[outPos++] = (char)255;
+		length -= 255;
+	}
+	if(outPos >= destCapacity)
+		return -1;
+	dest[outPos++] = (char)length;
+	return outPos;
+}
+
+// Appends a run of 'literalLength' literals followed by a match (no match for the last run, matchLength 0).
+static int writeRun(char *dest, int outPos, int destCapacity, const char *literals, int literalLength, int offset, int matchLength) {
+	if(outPos >= destCapacity)
+		return -1;
+	int tokenPos = outPos++;
+	int literalNibble = literalLength < 15 ? literalLength : 15;
+	int matchNibble = 0;
+	if(matchLength > 0)
+		matchNibble = (matchLength - MIN_MATCH) < 15 ? matchLength - MIN_MATCH : 15;
+	dest[tokenPos] = (char)((literalNibble << 4) | matchNibble);
+
+	if(literalNibble == 15 && (outPos = writeLength(dest, outPos, destCapacity, literalLength - 15)) < 0)
+		return -1;
+	if(outPos + literalLength > destCapacity)
+		return -1;
+	memcpy(dest + outPos, literals, literalLength);
+	outPos += literalLength;
+
+	if(matchLength == 0)
+		return outPos;
+	if(outPos + 2 > destCapacity)
+		return -1;
+	dest[outPos++] = (char)(offset & 0xFF);
+	dest[outPos++] = (char)(offset >> 8);
+	if(matchNibble == 15 && (outPos = writeLength(dest, outPos, destCapacity, matchLength - MIN_MATCH - 15)) < 0)
+		return -1;
+	return outPos;
+}
+
+// Reads the continuation of a length nibble. Returns the new input position or -1 for a damaged block.
+static int readLength(const unsigned char *source, int inPos, int sourceLength, int *length) {
+	unsigned char extra;
+	do {
+		if(inPos >= sourceLength)
+			return -1;
+		extra = source[inPos++];
+		*length += extra;
+	} while(extra == 255);
+	return inPos;
+}
+
+// ***** COMPRESSION FUNCTIONS ***** //
+
+extern int compressBlock (const char *source, int sourceLength, char *dest, int destCapacity) {
+	// Last position of every hashed 4 byte sequence, -1 when not seen yet
+	int lastPosition[1 << HASH_BITS];
+	memset(lastPosition, 0xFF, sizeof(lastPosition));
+
+	int inPos = 0;
+	int anchor = 0;
+	int outPos = 0;
+	while(inPos + MIN_MATCH <= sourceLength) {
+		uint32_t word = readWord(source + inPos);
+		int hash = hashWord(word);
+		int candidate = lastPosition[hash];
+		lastPosition[hash] = inPos;
+
+		if(candidate < 0 || inPos - candidate > MAX_OFFSET || readWord(source + candidate) != word) {
+			inPos++;
+			continue;
+		}
+
+		// Extending the match as far as possible. It may overlap the current position, which is how
+		// long runs of padding turn into a single match with offset 1.
+		int matchLength = MIN_MATCH;
+		while(inPos + matchLength < sourceLength && source[candidate + matchLength] == source[inPos + matchLength])
+			matchLength++;
+
+		outPos = writeRun(dest, outPos, destCapacity, source + anchor, inPos - anchor, inPos - candidate, matchLength);
+		if(outPos < 0)
+			return 0;
+		inPos += matchLength;
+		anchor = inPos;
+	}
+
+	// The remaining bytes are stored as literals of the last run
+	if(anchor < sourceLength || outPos == 0)
+		outPos = writeRun(dest, outPos, destCapacity, source + anchor, sourceLength - anchor, 0, 0);
+	return outPos < 0 ? 0 : outPos;
+}
+
+extern RC decompressBlock (const char *source, int sourceLength, char *dest, int destLength) {
+	const unsigned char *input = (const unsigned char *)source;
+	int inPos = 0;
+	int outPos = 0;
+
+	while(inPos < sourceLength) {
+		int token = input[inPos++];
+
+		// Copying the literals of the run
+		int literalLength = token >> 4;
+		if(literalLength == 15 && (inPos = readLength(input, inPos, sourceLength, &literalLength)) < 0)
+			return RC_ERROR;
+		if(inPos + literalLength > sourceLength || outPos + literalLength > destLength)
+			return RC_ERROR;
+		memcpy(dest + outPos, input + inPos, literalLength);
+		inPos += literalLength;
+		outPos += literalLength;
+
+		// The last run has no match
+		if(inPos == sourceLength)
+			break;
+
+		if(inPos + 2 > sourceLength)
+			return RC_ERROR;
+		int offset = input[inPos] | (input[inPos + 1] << 8);
+		inPos += 2;
+		int matchLength = (token & 0x0F) + MIN_MATCH;
+		if((token & 0x0F) == 15 && (inPos = readLength(input, inPos, sourceLength, &matchLength)) < 0)
+			return RC_ERROR;
+		if(offset == 0 || offset > outPos || outPos + matchLength > destLength)
+			return RC_ERROR;
+
+		// Copying byte by byte, the match may overlap the bytes it produces
+		int iter;
+		for(iter = 0; iter < matchLength; iter++)
+			dest[outPos + iter] = dest[outPos - offset + iter];
+		outPos += matchLength;
+	}
+
+	// A damaged block could end early
+	return outPos == destLength ? RC_OK : RC_ERROR;
+}
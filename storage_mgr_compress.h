@@ -0,0 +1,16 @@
+#ifndef STORAGE_MGR_COMPRESS_H
+#define STORAGE_MGR_COMPRESS_H
+
+#include "dberror.h"
+
+/************************************************************
+ *                    interface                             *
+ ************************************************************/
+/* LZ77 block compression in the style of LZ4, used for the pages of compressed page files.
+   compressBlock returns the size of the compressed block, or 0 if it does not fit into destCapacity bytes. */
+extern int compressBlock (const char *source, int sourceLength, char *dest, int destCapacity);
+
+/* decompresses a block produced by compressBlock, which has to expand to exactly destLength bytes */
+extern RC decompressBlock (const char *source, int sourceLength, char *dest, int destLength);
+
+#endif
@@ -0,0 +1,631 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "storage_mgr.h"
+#include "storage_mgr_async.h"
+#include "dberror.h"
+#include "test_helper.h"
+
+// test name
+char *testName;
+
+/* test output files */
+#define TESTPF "test_pagefile.bin"
+#define TESTPF_COPY "test_pagefile_copy.bin"
+
+/* prototypes for test functions */
+static void testMemoryMappedFile (void);
+static void testAsyncIO (void);
+static void testMultiPageIO (void);
+static void testExtentGrowth (void);
+static void testChecksums (void);
+static void testCompressedFile (void);
+static void testPageSizes (void);
+static void testAsyncEngine (SM_AsyncEngine engine);
+
+/* main function running all tests */
+int
+main (void)
+{
+  testName = "";
+
+  initStorageManager();
+
+  testMemoryMappedFile();
+  testAsyncIO();
+  testMultiPageIO();
+  testExtentGrowth();
+  testChecksums();
+  testCompressedFile();
+  testPageSizes();
+
+  return 0;
+}
+
+// fill a page with the string "Page-<pageNum>" followed by zeros
+static void
+fillPage (SM_PageHandle ph, int pageSize, int pageNum)
+{
+  memset(ph, 0, pageSize);
+  sprintf(ph, "Page-%i", pageNum);
+}
+
+/* Try to write pages through a memory mapped handle, read them back through the mapping and through
+   a plain handle, and check that a read-only mapping refuses to change the file */
+void
+testMemoryMappedFile (void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph, address;
+  char expected[32];
+  int i;
+
+  testName = "test memory mapped page file";
+
+  ph = (SM_PageHandle) malloc(PAGE_SIZE);
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_IO_MMAP));
+
+  // writing behind the end grows the file and the mapping
+  for (i = 0; i < 5; i++)
+    {
+      fillPage(ph, PAGE_SIZE, i);
+      TEST_CHECK(writeBlock (i, &fh, ph));
+    }
+  ASSERT_EQUALS_INT(5, fh.totalNumPages, "mapped file grew to 5 pages");
+  TEST_CHECK(ensureCapacity (8, &fh));
+  ASSERT_EQUALS_INT(8, fh.totalNumPages, "ensureCapacity grows the mapping");
+
+  // pages are copied out of the mapping, and the mapping can also be read directly
+  TEST_CHECK(readBlock (3, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-3", ph, "page read from the mapping");
+  TEST_CHECK(getBlockAddress (4, &fh, &address));
+  ASSERT_EQUALS_STRING("Page-4", address, "page at its address in the mapping");
+  TEST_CHECK(readBlock (7, &fh, ph));
+  ASSERT_TRUE(ph[0] == 0, "page the file grew by is empty");
+  ASSERT_ERROR(readBlock (8, &fh, ph), "reading behind the end of the mapping");
+  TEST_CHECK(closePageFile (&fh));
+
+  // the pages reached the file
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(8, fh.totalNumPages, "pages of the mapped file");
+  ASSERT_ERROR(getBlockAddress (0, &fh, &address), "a plain handle has no mapping");
+  for (i = 0; i < 5; i++)
+    {
+      TEST_CHECK(readBlock (i, &fh, ph));
+      sprintf(expected, "Page-%i", i);
+      ASSERT_EQUALS_STRING(expected, ph, "page written through the mapping");
+    }
+  TEST_CHECK(closePageFile (&fh));
+
+  // a read-only mapping can be read, but neither written nor grown
+  TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_IO_MMAP_READ_ONLY));
+  TEST_CHECK(readBlock (2, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-2", ph, "page read from the read-only mapping");
+  ASSERT_ERROR(writeBlock (2, &fh, ph), "writing to a read-only mapping");
+  ASSERT_ERROR(appendEmptyBlock (&fh), "growing a read-only mapping");
+  ASSERT_EQUALS_INT(8, fh.totalNumPages, "read-only mapping did not grow");
+  TEST_CHECK(closePageFile (&fh));
+
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* Run the asynchronous I/O tests with the worker thread engine, and with io_uring if the kernel offers it */
+void
+testAsyncIO (void)
+{
+  SM_AsyncContext *context;
+
+  testAsyncEngine(SM_ASYNC_THREAD_POOL);
+  if (initAsyncIOWithEngine(&context, 0, SM_ASYNC_IO_URING) == RC_OK)
+    {
+      TEST_CHECK(shutdownAsyncIO(context));
+      testAsyncEngine(SM_ASYNC_IO_URING);
+    }
+}
+
+#define ASYNC_PAGES 8
+
+/* Try to write and read a batch of pages through an asynchronous I/O context, waiting for the
+   writes and polling for the reads */
+void
+testAsyncEngine (SM_AsyncEngine engine)
+{
+  SM_FileHandle fh;
+  SM_AsyncContext *context;
+  SM_AsyncRequest requests[ASYNC_PAGES];
+  SM_AsyncRequest request;
+  char *pages = (char *) malloc(ASYNC_PAGES * PAGE_SIZE);
+  char expected[32];
+  int i;
+
+  testName = (engine == SM_ASYNC_THREAD_POOL) ? "test asynchronous I/O with worker threads" : "test asynchronous I/O with io_uring";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  TEST_CHECK(ensureCapacity (ASYNC_PAGES, &fh));
+  TEST_CHECK(initAsyncIOWithEngine(&context, 4, engine));
+  ASSERT_TRUE(getAsyncIOEngine(context) == engine, "context uses the requested engine");
+
+  // a request that was never submitted cannot complete
+  memset(&request, 0, sizeof(request));
+  ASSERT_ERROR(waitAsyncIO(context, &request), "waiting for a request that was never submitted");
+
+  // one batch of writes, more than the queue depth
+  for (i = 0; i < ASYNC_PAGES; i++)
+    {
+      fillPage(pages + i * PAGE_SIZE, PAGE_SIZE, i);
+      requests[i].op = SM_ASYNC_WRITE;
+      requests[i].pageNum = i;
+      requests[i].memPage = pages + i * PAGE_SIZE;
+    }
+  TEST_CHECK(submitAsyncIO(context, &fh, requests, ASYNC_PAGES));
+  TEST_CHECK(waitAsyncIO(context, &requests[ASYNC_PAGES - 1]));
+  TEST_CHECK(waitAllAsyncIO(context));
+  for (i = 0; i < ASYNC_PAGES; i++)
+    TEST_CHECK(requests[i].result);
+  ASSERT_EQUALS_INT(0, pollAsyncIO(context), "no request in flight after waiting for all");
+
+  // one batch of reads in reverse order, polled until all are done
+  memset(pages, 0, ASYNC_PAGES * PAGE_SIZE);
+  for (i = 0; i < ASYNC_PAGES; i++)
+    {
+      requests[i].op = SM_ASYNC_READ;
+      requests[i].pageNum = ASYNC_PAGES - 1 - i;
+      requests[i].memPage = pages + i * PAGE_SIZE;
+    }
+  TEST_CHECK(submitAsyncIO(context, &fh, requests, ASYNC_PAGES));
+  while (pollAsyncIO(context) > 0)
+    ;
+  for (i = 0; i < ASYNC_PAGES; i++)
+    {
+      ASSERT_TRUE(requests[i].done, "polled request is done");
+      TEST_CHECK(waitAsyncIO(context, &requests[i]));
+      sprintf(expected, "Page-%i", ASYNC_PAGES - 1 - i);
+      ASSERT_EQUALS_STRING(expected, pages + i * PAGE_SIZE, "page read asynchronously");
+    }
+
+  // a page behind the end of the file completes with an error
+  request.op = SM_ASYNC_READ;
+  request.pageNum = ASYNC_PAGES;
+  request.memPage = pages;
+  TEST_CHECK(submitAsyncIO(context, &fh, &request, 1));
+  ASSERT_EQUALS_INT(RC_READ_NON_EXISTING_PAGE, waitAsyncIO(context, &request), "reading behind the end of the file");
+
+  TEST_CHECK(shutdownAsyncIO(context));
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(pages);
+
+  TEST_DONE();
+}
+
+#define RUN_PAGES 6
+
+/* Try to write a run of pages with one writeBlocks call, read it back with readBlocks and walk
+   through it with the sequential read functions */
+void
+testMultiPageIO (void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle memPages[RUN_PAGES];
+  SM_PageHandle ph = (SM_PageHandle) malloc(PAGE_SIZE);
+  char *run = (char *) malloc(RUN_PAGES * PAGE_SIZE);
+  char expected[32];
+  int i;
+
+  testName = "test multi-page reads and writes";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+
+  // writing pages 1 .. RUN_PAGES from separate buffers appends to the file
+  for (i = 0; i < RUN_PAGES; i++)
+    {
+      memPages[i] = (SM_PageHandle) malloc(PAGE_SIZE);
+      fillPage(memPages[i], PAGE_SIZE, i + 1);
+    }
+  TEST_CHECK(writeBlocks (1, RUN_PAGES, &fh, memPages));
+  ASSERT_EQUALS_INT(RUN_PAGES + 1, fh.totalNumPages, "run written behind the end appends");
+  ASSERT_EQUALS_INT(RUN_PAGES, getBlockPos(&fh), "position is the last page written");
+  ASSERT_ERROR(writeBlocks (RUN_PAGES + 2, 1, &fh, memPages), "run starting behind the end of the file");
+  ASSERT_ERROR(writeBlocks (0, 0, &fh, memPages), "empty run");
+
+  // reading the run back into one buffer
+  TEST_CHECK(readBlocks (1, RUN_PAGES, &fh, run));
+  for (i = 0; i < RUN_PAGES; i++)
+    {
+      sprintf(expected, "Page-%i", i + 1);
+      ASSERT_EQUALS_STRING(expected, run + i * PAGE_SIZE, "page of the run read back");
+    }
+  ASSERT_EQUALS_INT(RUN_PAGES, getBlockPos(&fh), "position is the last page read");
+  ASSERT_ERROR(readBlocks (2, RUN_PAGES, &fh, run), "run reaching behind the end of the file");
+  ASSERT_ERROR(readBlocks (-1, 2, &fh, run), "run before the first page");
+
+  // the sequential functions read whole blocks and move the position
+  TEST_CHECK(readFirstBlock (&fh, ph));
+  ASSERT_TRUE(ph[0] == 0, "first page was never written");
+  ASSERT_ERROR(readPreviousBlock (&fh, ph), "no page before the first page");
+  TEST_CHECK(readNextBlock (&fh, ph));
+  ASSERT_EQUALS_STRING("Page-1", ph, "next block");
+  TEST_CHECK(readNextBlock (&fh, ph));
+  TEST_CHECK(readCurrentBlock (&fh, ph));
+  ASSERT_EQUALS_STRING("Page-2", ph, "current block");
+  TEST_CHECK(readPreviousBlock (&fh, ph));
+  ASSERT_EQUALS_STRING("Page-1", ph, "previous block");
+  TEST_CHECK(readLastBlock (&fh, ph));
+  sprintf(expected, "Page-%i", RUN_PAGES);
+  ASSERT_EQUALS_STRING(expected, ph, "last block");
+  ASSERT_ERROR(readNextBlock (&fh, ph), "no page behind the last page");
+
+  // writeCurrentBlock overwrites the page at the position
+  fillPage(ph, PAGE_SIZE, 99);
+  TEST_CHECK(writeCurrentBlock (&fh, ph));
+  TEST_CHECK(readBlock (RUN_PAGES, &fh, run));
+  ASSERT_EQUALS_STRING("Page-99", run, "current block overwritten");
+  ASSERT_EQUALS_INT(RUN_PAGES + 1, fh.totalNumPages, "overwriting does not grow the file");
+
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  for (i = 0; i < RUN_PAGES; i++)
+    free(memPages[i]);
+  free(run);
+  free(ph);
+
+  TEST_DONE();
+}
+
+// pages of the page file according to its size, and pages the file system has allocated for it
+static void
+getFilePages (char *fileName, int *sizePages, int *allocatedPages)
+{
+  struct stat fileInfo;
+  stat(fileName, &fileInfo);
+  *sizePages = fileInfo.st_size / PAGE_SIZE;
+  *allocatedPages = (long long) fileInfo.st_blocks * 512 / PAGE_SIZE;
+}
+
+/* Try to grow a file in extents: the file size follows the logical pages, while space is
+   reserved a whole extent at a time */
+void
+testExtentGrowth (void)
+{
+  SM_FileHandle fh;
+  SM_PageHandle ph = (SM_PageHandle) malloc(PAGE_SIZE);
+  int sizePages, allocatedPages;
+
+  testName = "test extent based file growth";
+
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_ERROR(setGrowthExtent (&fh, -1), "negative extent");
+  TEST_CHECK(setGrowthExtent (&fh, 16));
+
+  // one more page reserves the first extent, but only adds one page to the file
+  TEST_CHECK(appendEmptyBlock (&fh));
+  getFilePages(TESTPF, &sizePages, &allocatedPages);
+  ASSERT_EQUALS_INT(2, fh.totalNumPages, "logical pages after appending");
+  ASSERT_EQUALS_INT(2, sizePages, "file size after appending");
+
+  // file systems without fallocate leave the file sparse, then there is no reservation to check
+  if (allocatedPages >= sizePages)
+    ASSERT_TRUE(allocatedPages >= 16, "a whole extent is reserved");
+
+  // growing is rounded up to whole extents
+  TEST_CHECK(ensureCapacity (20, &fh));
+  getFilePages(TESTPF, &sizePages, &allocatedPages);
+  ASSERT_EQUALS_INT(20, fh.totalNumPages, "logical pages after ensureCapacity");
+  ASSERT_EQUALS_INT(20, sizePages, "file size after ensureCapacity");
+  if (allocatedPages >= sizePages)
+    ASSERT_TRUE(allocatedPages >= 32, "reservation rounded up to the next extent");
+
+  // geometric growth doubles the reservation
+  TEST_CHECK(setGrowthExtent (&fh, SM_GROWTH_GEOMETRIC));
+  TEST_CHECK(ensureCapacity (40, &fh));
+  getFilePages(TESTPF, &sizePages, &allocatedPages);
+  ASSERT_EQUALS_INT(40, sizePages, "file size after geometric growth");
+  if (allocatedPages >= sizePages)
+    ASSERT_TRUE(allocatedPages >= 64, "reservation doubled");
+
+  // writing directly behind the last page appends exactly one page, pages the file grew by are empty
+  fillPage(ph, PAGE_SIZE, 40);
+  TEST_CHECK(writeBlock (40, &fh, ph));
+  ASSERT_EQUALS_INT(41, fh.totalNumPages, "write behind the last page appends");
+  TEST_CHECK(readBlock (30, &fh, ph));
+  ASSERT_TRUE(ph[0] == 0, "page the file grew by is empty");
+  TEST_CHECK(closePageFile (&fh));
+
+  // a new handle counts the logical pages, not the reserved space
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(41, fh.totalNumPages, "logical pages after reopening");
+  TEST_CHECK(readBlock (40, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-40", ph, "appended page");
+  TEST_CHECK(closePageFile (&fh));
+
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(ph);
+
+  TEST_DONE();
+}
+
+// overwrites one byte of a file at offset, like a torn write or bit rot would
+static void
+corruptFile (char *fileName, long offset)
+{
+  FILE *file = fopen(fileName, "r+b");
+  int byte;
+  fseek(file, offset, SEEK_SET);
+  byte = fgetc(file);
+  fseek(file, offset, SEEK_SET);
+  fputc(byte ^ 0x5A, file);
+  fclose(file);
+}
+
+/* Try to detect a damaged page of a checksummed file, and to read it once verification is turned off */
+void
+testChecksums (void)
+{
+  SM_FileHandle fh;
+  SM_FileFormat format = { .checksums = true };
+  SM_PageHeader header = { .pageType = SM_PAGE_TYPE_DATA, .lsn = 42 };
+  SM_PageHandle ph = (SM_PageHandle) malloc(3 * PAGE_SIZE);
+  int i;
+
+  testName = "test page checksums";
+
+  TEST_CHECK(createPageFileWithFormat (TESTPF, &format));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(1, fh.totalNumPages, "checksummed file starts with one page");
+
+  // the first page was never written, it reads as an empty page
+  TEST_CHECK(readBlock (0, &fh, ph));
+  ASSERT_TRUE(ph[0] == 0, "page never written is empty");
+  for (i = 0; i < 3; i++)
+    {
+      fillPage(ph, PAGE_SIZE, i);
+      TEST_CHECK(writeBlockWithHeader (i, &fh, ph, &header));
+    }
+  TEST_CHECK(readPageHeader (1, &fh, &header));
+  ASSERT_EQUALS_INT(42, (int) header.lsn, "LSN stored in the page header");
+  ASSERT_TRUE(header.checksum != 0, "written page has a checksum");
+  TEST_CHECK(closePageFile (&fh));
+
+  // checksummed pages are neither aligned nor adjacent, they cannot be mapped
+  ASSERT_ERROR(openPageFileWithMode (TESTPF, &fh, SM_IO_MMAP), "mapping a checksummed file");
+
+  // a damaged byte in the middle of page 1 is detected, the other pages still read
+  corruptFile(TESTPF, SM_FILE_HEADER_SIZE + (sizeof(SM_PageHeader) + PAGE_SIZE) + sizeof(SM_PageHeader) + 100);
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(RC_PAGE_CHECKSUM_MISMATCH, readBlock (1, &fh, ph), "damaged page detected");
+  ASSERT_EQUALS_INT(RC_PAGE_CHECKSUM_MISMATCH, readBlocks (0, 3, &fh, ph), "damaged page detected in a run");
+  TEST_CHECK(readBlock (2, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-2", ph, "undamaged page");
+
+  // turning verification off for this handle reads the page as it is
+  TEST_CHECK(setChecksumVerification (&fh, false));
+  TEST_CHECK(readBlock (1, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-1", ph, "damaged page read without verification");
+
+  // rewriting the page repairs it
+  TEST_CHECK(setChecksumVerification (&fh, true));
+  fillPage(ph, PAGE_SIZE, 1);
+  TEST_CHECK(writeBlock (1, &fh, ph));
+  TEST_CHECK(readBlock (1, &fh, ph));
+  ASSERT_EQUALS_STRING("Page-1", ph, "rewritten page verifies");
+  TEST_CHECK(closePageFile (&fh));
+
+  // a page header that was damaged is detected as well
+  corruptFile(TESTPF, SM_FILE_HEADER_SIZE + 2 * (sizeof(SM_PageHeader) + PAGE_SIZE) + 8);
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(RC_PAGE_CHECKSUM_MISMATCH, readBlock (2, &fh, ph), "damaged page header detected");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+
+  // files without checksums have nothing to verify
+  TEST_CHECK(createPageFile (TESTPF));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_ERROR(setChecksumVerification (&fh, false), "plain file has no checksums");
+  ASSERT_ERROR(readPageHeader (0, &fh, &header), "plain file has no page headers");
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(destroyPageFile (TESTPF));
+  free(ph);
+
+  TEST_DONE();
+}
+
+// fill a page with bytes that do not compress
+static void
+fillRandomPage (SM_PageHandle ph, int pageSize, unsigned int seed)
+{
+  int i;
+  for (i = 0; i < pageSize; i++)
+    {
+      seed = seed * 1103515245 + 12345;
+      ph[i] = (char) (seed >> 16);
+    }
+}
+
+// reads 'length' bytes of a file at 'offset'
+static void
+readFileBytes (char *fileName, long offset, char *buffer, int length)
+{
+  FILE *file = fopen(fileName, "rb");
+  fseek(file, offset, SEEK_SET);
+  if (fread(buffer, 1, length, file) != (size_t) length)
+    memset(buffer, 0, length);
+  fclose(file);
+}
+
+// copies a file, used to get the state of a file that is still open as if the process had crashed
+static void
+copyFile (char *from, char *to)
+{
+  FILE *source = fopen(from, "rb");
+  FILE *target = fopen(to, "wb");
+  char buffer[4096];
+  size_t length;
+  while ((length = fread(buffer, 1, sizeof(buffer), source)) > 0)
+    fwrite(buffer, 1, length, target);
+  fclose(source);
+  fclose(target);
+}
+
+// checks the pages written by testCompressedFile
+static void
+checkCompressedPages (SM_FileHandle *fh, SM_PageHandle ph)
+{
+  char *expected = (char *) malloc(PAGE_SIZE);
+
+  ASSERT_EQUALS_INT(4, fh->totalNumPages, "pages of the compressed file");
+  TEST_CHECK(readBlock (0, fh, ph));
+  memset(expected, ' ', PAGE_SIZE);
+  ASSERT_TRUE(memcmp(expected, ph, PAGE_SIZE) == 0, "page 0 after rewriting it with a smaller record");
+  TEST_CHECK(readBlock (1, fh, ph));
+  fillRandomPage(expected, PAGE_SIZE, 2);
+  ASSERT_TRUE(memcmp(expected, ph, PAGE_SIZE) == 0, "page 1 moved to a larger record");
+  TEST_CHECK(readBlock (2, fh, ph));
+  ASSERT_EQUALS_STRING("Page-2", ph, "page 2");
+  TEST_CHECK(readBlock (3, fh, ph));
+  ASSERT_TRUE(ph[0] == 0, "page 3 was never written");
+  free(expected);
+}
+
+/* Try to write pages of a compressed file, rewrite them with smaller and larger compressed output,
+   and recover the page map of a file that was not closed */
+void
+testCompressedFile (void)
+{
+  SM_FileHandle fh;
+  SM_FileFormat format = { .compressed = true, .checksums = true };
+  SM_PageHandle ph = (SM_PageHandle) malloc(PAGE_SIZE);
+  char *before = (char *) malloc(PAGE_SIZE / 2);
+  char *after = (char *) malloc(PAGE_SIZE / 2);
+  struct stat fileInfo;
+  long sizeBefore;
+
+  testName = "test compressed page file";
+
+  TEST_CHECK(createPageFileWithFormat (TESTPF, &format));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  ASSERT_EQUALS_INT(1, fh.totalNumPages, "compressed file starts with one page");
+  ASSERT_ERROR(openPageFileWithMode (TESTPF, &fh, SM_IO_MMAP), "mapping a compressed file");
+
+  // page 0 does not compress and becomes the first record, right behind the file header
+  fillRandomPage(ph, PAGE_SIZE, 1);
+  TEST_CHECK(writeBlock (0, &fh, ph));
+  fillPage(ph, PAGE_SIZE, 1);
+  TEST_CHECK(writeBlock (1, &fh, ph));
+  fillPage(ph, PAGE_SIZE, 2);
+  TEST_CHECK(writeBlock (2, &fh, ph));
+  TEST_CHECK(appendEmptyBlock (&fh));
+  TEST_CHECK(closePageFile (&fh));
+  stat(TESTPF, &fileInfo);
+  sizeBefore = fileInfo.st_size;
+  ASSERT_TRUE(sizeBefore < SM_FILE_HEADER_SIZE + 2 * PAGE_SIZE, "compressible pages take little space");
+  readFileBytes(TESTPF, SM_FILE_HEADER_SIZE + PAGE_SIZE / 2, before, PAGE_SIZE / 2);
+
+  // page 0 now compresses to a few bytes and is rewritten in place, the rest of its record is left as it was
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  memset(ph, ' ', PAGE_SIZE);
+  TEST_CHECK(writeBlock (0, &fh, ph));
+  TEST_CHECK(closePageFile (&fh));
+  stat(TESTPF, &fileInfo);
+  ASSERT_TRUE(fileInfo.st_size == sizeBefore, "smaller page rewritten in place");
+  readFileBytes(TESTPF, SM_FILE_HEADER_SIZE + PAGE_SIZE / 2, after, PAGE_SIZE / 2);
+  ASSERT_TRUE(memcmp(before, after, PAGE_SIZE / 2) == 0, "no bytes written behind the smaller page");
+
+  // page 1 no longer compresses and moves to a new record
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  fillRandomPage(ph, PAGE_SIZE, 2);
+  TEST_CHECK(writeBlock (1, &fh, ph));
+  checkCompressedPages(&fh, ph);
+
+  // while the file is open its page map is not on disk, a copy looks like a file that was not closed
+  copyFile(TESTPF, TESTPF_COPY);
+  TEST_CHECK(closePageFile (&fh));
+  TEST_CHECK(openPageFile (TESTPF, &fh));
+  checkCompressedPages(&fh, ph);
+  TEST_CHECK(closePageFile (&fh));
+
+  // the page map is rebuilt from the records, page 3 that was never written is lost from the page count
+  TEST_CHECK(openPageFile (TESTPF_COPY, &fh));
+  ASSERT_EQUALS_INT(3, fh.totalNumPages, "pages recovered from the records");
+  TEST_CHECK(appendEmptyBlock (&fh));
+  checkCompressedPages(&fh, ph);
+  TEST_CHECK(closePageFile (&fh));
+
+  TEST_CHECK(destroyPageFile (TESTPF));
+  TEST_CHECK(destroyPageFile (TESTPF_COPY));
+  free(before);
+  free(after);
+  free(ph);
+
+  TEST_DONE();
+}
+
+/* Try to create page files with other page sizes than PAGE_SIZE, and move their pages with the
+   descriptor and the memory mapped backends */
+void
+testPageSizes (void)
+{
+  SM_FileHandle fh;
+  SM_FileFormat format = { 0 };
+  int invalidSizes[] = { 256, 1000, 2 * SM_MAX_PAGE_SIZE };
+  int pageSizes[] = { 1024, 16384 };
+  char *pages = (char *) malloc(4 * 16384);
+  char expected[32];
+  int i, j, pageSize;
+
+  testName = "test page sizes";
+
+  for (i = 0; i < 3; i++)
+    {
+      format.pageSize = invalidSizes[i];
+      ASSERT_ERROR(createPageFileWithFormat (TESTPF, &format), "unsupported page size");
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      pageSize = pageSizes[i];
+      format.pageSize = pageSize;
+      TEST_CHECK(createPageFileWithFormat (TESTPF, &format));
+      TEST_CHECK(openPageFile (TESTPF, &fh));
+      ASSERT_EQUALS_INT(pageSize, fh.pageSize, "page size recorded in the file header");
+      ASSERT_EQUALS_INT(1, fh.totalNumPages, "file starts with one page");
+
+      // every page carries its number at the start and a marker in its last byte
+      for (j = 0; j < 4; j++)
+        {
+          fillPage(pages, pageSize, j);
+          pages[pageSize - 1] = 'A' + j;
+          TEST_CHECK(writeBlock (j, &fh, pages));
+        }
+      TEST_CHECK(closePageFile (&fh));
+
+      // O_DIRECT needs pages that are a multiple of its alignment
+      if (pageSize % SM_DIRECT_IO_ALIGNMENT != 0)
+        ASSERT_ERROR(openPageFileWithMode (TESTPF, &fh, SM_IO_DIRECT), "O_DIRECT with small pages");
+
+      TEST_CHECK(openPageFileWithMode (TESTPF, &fh, SM_IO_MMAP));
+      ASSERT_EQUALS_INT(pageSize, fh.pageSize, "page size of a mapped file");
+      ASSERT_EQUALS_INT(4, fh.totalNumPages, "pages of the file");
+      TEST_CHECK(readBlocks (0, 4, &fh, pages));
+      for (j = 0; j < 4; j++)
+        {
+          sprintf(expected, "Page-%i", j);
+          ASSERT_EQUALS_STRING(expected, pages + j * pageSize, "start of the page");
+          ASSERT_TRUE(pages[j * pageSize + pageSize - 1] == 'A' + j, "last byte of the page");
+        }
+      TEST_CHECK(closePageFile (&fh));
+      TEST_CHECK(destroyPageFile (TESTPF));
+    }
+  free(pages);
+
+  TEST_DONE();
+}
@@ -1,12 +1,19 @@
+#define _GNU_SOURCE
 #include "storage_mgr.h"
 #include "buffer_mgr_stat.h"
 #include "buffer_mgr.h"
+#include "buffer_mgr_policy.h"
 #include "dberror.h"
 #include "test_helper.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
 
 // var to store the current test name
 char *testName;
@@ -37,6 +44,23 @@ static void testReadPage (void);
 
 static void testFIFO (void);
 static void testLRU (void);
+static void testZeroCopy (void);
+static void testDirectIO (void);
+static void testIndependentPools (void);
+static void testLRUPinnedPages (void);
+static void testCustomPolicy (void);
+static void testConcurrentClients (void);
+static void testPartitionedPool (void);
+static void testBackgroundWriter (void);
+static void testPrefetch (void);
+static void testAccessStrategy (void);
+static void testBatchPinning (void);
+static void testResizePool (void);
+static void testWarmStart (void);
+static void testPoolStats (void);
+static void testPageSizes (void);
+static void testPageTableCollisions (void);
+static void testFailedWriteBack (void);
 
 // main method
 int 
@@ -49,6 +73,23 @@ main (void)
   testReadPage();
   testFIFO();
   testLRU();
+  testZeroCopy();
+  testDirectIO();
+  testIndependentPools();
+  testLRUPinnedPages();
+  testCustomPolicy();
+  testConcurrentClients();
+  testPartitionedPool();
+  testBackgroundWriter();
+  testPrefetch();
+  testAccessStrategy();
+  testBatchPinning();
+  testResizePool();
+  testWarmStart();
+  testPoolStats();
+  testPageSizes();
+  testPageTableCollisions();
+  testFailedWriteBack();
 }
 
 // create n pages with content "Page X" and read them back to check whether the content is right
@@ -299,4 +340,1326 @@ testLRU (void)
   free(bm);
   free(h);
   TEST_DONE();
-}
\ No newline at end of file
+}
+// test that a zero-copy pool hands out the pages of the file without copying them
+void
+testZeroCopy (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .zeroCopy = true };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing zero-copy pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content from the mapping");
+      CHECK(unpinPage(bm, h));
+    }
+
+  // pages are read-only and cannot be created behind the end of the file
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_ERROR(markDirty(bm, h), "pages of a zero-copy pool cannot be marked dirty");
+  CHECK(unpinPage(bm, h));
+  ASSERT_ERROR(pinPage(bm, h, 10), "zero-copy pool cannot pin a page behind the end of the file");
+  ASSERT_EQUALS_INT(11, getNumReadIO(bm), "failed load is no read I/O");
+
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test a pool that bypasses the page cache with O_DIRECT
+void
+testDirectIO (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .directIO = true };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing O_DIRECT pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_LRU, NULL, &options));
+
+  // create pages behind the end of the file, evicting the frames writes them back
+  for (i = 0; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  // read them back through a fresh pool
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  for (i = 9; i >= 0; i--)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", h->pageNum);
+      ASSERT_EQUALS_STRING(expected, h->data, "reading back page content with O_DIRECT");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "check number of write I/Os");
+  CHECK(shutdownBufferPool(bm));
+
+  // a read-only mapping cannot be combined with O_DIRECT
+  options.zeroCopy = true;
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options), "zero-copy and O_DIRECT pool");
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that two pools used at the same time keep their own replacement state and I/O counters
+void
+testIndependentPools (void)
+{
+  int i;
+  BM_BufferPool *fifoPool = MAKE_POOL();
+  BM_BufferPool *lruPool = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing independent buffer pools";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(createPageFile("testbuffer2.bin"));
+  createDummyPages(fifoPool, 10);
+  CHECK(initBufferPool(fifoPool, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(initBufferPool(lruPool, "testbuffer2.bin", 3, RS_LRU, NULL));
+
+  // interleave the requests of both pools, only the FIFO pool modifies its pages
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(fifoPool, h, i));
+      CHECK(markDirty(fifoPool, h));
+      CHECK(unpinPage(fifoPool, h));
+      CHECK(pinPage(lruPool, h, i));
+      CHECK(unpinPage(lruPool, h));
+    }
+  CHECK(pinPage(lruPool, h, 0));
+  CHECK(unpinPage(lruPool, h));
+  for (i = 3; i < 5; i++)
+    {
+      CHECK(pinPage(lruPool, h, i));
+      CHECK(unpinPage(lruPool, h));
+      CHECK(pinPage(fifoPool, h, i));
+      CHECK(unpinPage(fifoPool, h));
+    }
+
+  ASSERT_EQUALS_POOL("[3 0],[4 0],[2x0]", fifoPool, "check FIFO pool content");
+  ASSERT_EQUALS_POOL("[0 0],[3 0],[4 0]", lruPool, "check LRU pool content");
+  ASSERT_EQUALS_INT(2, getNumWriteIO(fifoPool), "check number of write I/Os of the FIFO pool");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(lruPool), "check number of write I/Os of the LRU pool");
+  ASSERT_EQUALS_INT(5, getNumReadIO(fifoPool), "check number of read I/Os of the FIFO pool");
+  ASSERT_EQUALS_INT(5, getNumReadIO(lruPool), "check number of read I/Os of the LRU pool");
+
+  CHECK(shutdownBufferPool(fifoPool));
+  CHECK(shutdownBufferPool(lruPool));
+  CHECK(destroyPageFile("testbuffer.bin"));
+  CHECK(destroyPageFile("testbuffer2.bin"));
+
+  free(fifoPool);
+  free(lruPool);
+  free(h);
+  TEST_DONE();
+}
+
+// test that LRU replacement passes over pages that are still pinned
+void
+testLRUPinnedPages (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  testName = "Testing LRU page replacement with pinned pages";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+
+  // page 0 is the least recently used page but stays pinned
+  CHECK(pinPage(bm, pinned, 0));
+  for (i = 1; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL("[0 1],[1 0],[2 0]", bm, "check pool content reading in pages");
+
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 1],[3 0],[2 0]", bm, "page 1 is replaced instead of the pinned page 0");
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 1],[3 0],[4 0]", bm, "page 2 is replaced next");
+
+  // with all frames pinned no page can be replaced
+  CHECK(pinPage(bm, h, 3));
+  CHECK(pinPage(bm, h, 4));
+  ASSERT_ERROR(pinPage(bm, h, 5), "pinning a page while all frames are pinned");
+
+  CHECK(unpinPage(bm, h));
+  h->pageNum = 3;
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, pinned));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+// a replacement policy that always replaces the unpinned frame with the highest index, counting the hook calls
+static int numPolicyLoads, numPolicyHits, numPolicyUnpins, numPolicyEvicts, numPolicyRemoves;
+
+static RC
+lastFrameInit (void **policyData, int numFrames, void *stratData)
+{
+  int *numFramesData = malloc(sizeof(int));
+  *numFramesData = numFrames;
+  *policyData = numFramesData;
+  return RC_OK;
+}
+
+static void
+lastFrameShutdown (void *policyData)
+{
+  free(policyData);
+}
+
+static void
+lastFrameOnLoad (void *policyData, int frameIndex, PageNumber pageNum)
+{
+  numPolicyLoads++;
+}
+
+static void
+lastFrameOnHit (void *policyData, int frameIndex)
+{
+  numPolicyHits++;
+}
+
+static void
+lastFrameOnUnpin (void *policyData, int frameIndex)
+{
+  numPolicyUnpins++;
+}
+
+static int
+lastFramePickVictim (void *policyData, BM_BufferPool *const bm, PageNumber pageNum)
+{
+  int i;
+  for (i = *(int *) policyData - 1; i >= 0; i--)
+    if (getFrameFixCount(bm, i) == 0)
+      return i;
+  return -1;
+}
+
+static void
+lastFrameOnEvict (void *policyData, int frameIndex, PageNumber pageNum)
+{
+  numPolicyEvicts++;
+}
+
+static void
+lastFrameOnRemove (void *policyData, int frameIndex, PageNumber pageNum)
+{
+  numPolicyRemoves++;
+}
+
+static const BM_ReplacementPolicy lastFramePolicy = {
+  "LAST FRAME", lastFrameInit, lastFrameShutdown, lastFrameOnLoad, lastFrameOnHit,
+  lastFrameOnUnpin, lastFramePickVictim, lastFrameOnEvict
+};
+
+static const BM_ReplacementPolicy lastFrameRemovePolicy = {
+  "LAST FRAME", lastFrameInit, lastFrameShutdown, lastFrameOnLoad, lastFrameOnHit,
+  lastFrameOnUnpin, lastFramePickVictim, lastFrameOnEvict, NULL, NULL, lastFrameOnRemove
+};
+
+// test a pool that uses a replacement policy passed through the pool options
+void
+testCustomPolicy (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .policy = &lastFramePolicy };
+  BM_AccessStrategy access;
+  testName = "Testing custom replacement policy";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+
+  // the last frame is replaced again and again
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[3 0]", bm, "check pool content after replacing the last frame");
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[1 0],[4 0]", bm, "check pool content after replacing the last frame again");
+
+  // a pinned last frame is passed over
+  CHECK(pinPage(bm, pinned, 4));
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL("[0 0],[5 0],[4 1]", bm, "check pool content with a pinned last frame");
+  CHECK(unpinPage(bm, pinned));
+
+  ASSERT_EQUALS_INT(6, numPolicyLoads, "check number of onLoad calls");
+  ASSERT_EQUALS_INT(2, numPolicyHits, "check number of onHit calls");
+  ASSERT_EQUALS_INT(8, numPolicyUnpins, "check number of onUnpin calls");
+  ASSERT_EQUALS_INT(3, numPolicyEvicts, "check number of onEvict calls");
+
+  CHECK(shutdownBufferPool(bm));
+
+  // a policy without initFrom is created again by init when the pool is resized, unless init got stratData
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  CHECK(resizeBufferPool(bm, 4));
+  ASSERT_EQUALS_INT(4, bm->numPages, "custom policy resized");
+  CHECK(shutdownBufferPool(bm));
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, &i, &options));
+  ASSERT_ERROR(resizeBufferPool(bm, 4), "stratData is not kept for init");
+  ASSERT_EQUALS_INT(3, bm->numPages, "pool not resized");
+  CHECK(shutdownBufferPool(bm));
+
+  // a frame recycled by an access strategy was not picked by the policy, it goes to onRemove
+  options.policy = &lastFrameRemovePolicy;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options));
+  CHECK(initAccessStrategy(&access, 1));
+  for (i = 5; i < 8; i++)
+    {
+      CHECK(pinPageWithStrategy(bm, h, i, &access));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(freeAccessStrategy(&access));
+  ASSERT_EQUALS_POOL("[7 0],[-1 0],[-1 0]", bm, "ring recycled the first frame");
+  ASSERT_EQUALS_INT(2, numPolicyRemoves, "check number of onRemove calls");
+  ASSERT_EQUALS_INT(3, numPolicyEvicts, "recycled frames do not go to onEvict");
+  CHECK(shutdownBufferPool(bm));
+
+  // a strategy without a built-in policy is rejected
+  ASSERT_ERROR(initBufferPool(bm, "testbuffer.bin", 3, (ReplacementStrategy) 42, NULL), "unknown replacement strategy");
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+// every client thread increments counters stored in the pages of a shared pool
+#define CONCURRENT_CLIENTS 8
+#define CONCURRENT_PAGES 40
+#define CONCURRENT_INCREMENTS 2000
+
+static void *
+incrementPageCounters (void *arg)
+{
+  BM_BufferPool *bm = (BM_BufferPool *) arg;
+  BM_PageHandle h;
+  unsigned int seed = (unsigned int) (size_t) &h;
+  int i;
+
+  for (i = 0; i < CONCURRENT_INCREMENTS; i++)
+    {
+      // all frames may be pinned by the other clients for a moment
+      while (pinPage(bm, &h, rand_r(&seed) % CONCURRENT_PAGES) == RC_PINNED_PAGES_IN_BUFFER)
+        sched_yield();
+      latchPage(bm, &h, true);
+      (*(int *) h.data)++;
+      markDirty(bm, &h);
+      unlatchPage(bm, &h);
+      unpinPage(bm, &h);
+    }
+  return NULL;
+}
+
+// a client forcing a page another client has latched
+typedef struct ForceRequest {
+  BM_BufferPool *bm;
+  BM_PageHandle page;
+  RC result;
+  int done;
+} ForceRequest;
+
+static void *
+forceLatchedPage (void *arg)
+{
+  ForceRequest *request = (ForceRequest *) arg;
+  request->result = forcePage(request->bm, &request->page);
+  __atomic_store_n(&request->done, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+// test that clients pinning, modifying and unpinning pages at the same time do not lose updates
+void
+testConcurrentClients (void)
+{
+  int i, total = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  pthread_t clients[CONCURRENT_CLIENTS];
+  testName = "Testing concurrent clients";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_LRU, NULL));
+
+  for (i = 0; i < CONCURRENT_CLIENTS; i++)
+    pthread_create(&clients[i], NULL, incrementPageCounters, bm);
+  for (i = 0; i < CONCURRENT_CLIENTS; i++)
+    pthread_join(clients[i], NULL);
+  CHECK(shutdownBufferPool(bm));
+
+  // read the counters back through a fresh pool
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_FIFO, NULL));
+  for (i = 0; i < CONCURRENT_PAGES; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      total += *(int *) h->data;
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(CONCURRENT_CLIENTS * CONCURRENT_INCREMENTS, total, "check that no increment was lost");
+
+  // forcePage writes a page only once the client modifying it released its latch
+  CHECK(pinPage(bm, h, 0));
+  CHECK(latchPage(bm, h, true));
+  sprintf(h->data, "%s", "Page-0-half");
+  CHECK(markDirty(bm, h));
+  ForceRequest request = { bm, *h, RC_OK, 0 };
+  pthread_create(&clients[0], NULL, forceLatchedPage, &request);
+  usleep(50000);
+  ASSERT_EQUALS_INT(0, __atomic_load_n(&request.done, __ATOMIC_ACQUIRE), "forcePage waits for the exclusive latch");
+  sprintf(h->data, "%s", "Page-0-latched");
+  CHECK(unlatchPage(bm, h));
+  pthread_join(clients[0], NULL);
+  CHECK(request.result);
+
+  // the client holding the latch exclusively may force the page itself
+  CHECK(latchPage(bm, h, true));
+  CHECK(forcePage(bm, h));
+  CHECK(unlatchPage(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_FIFO, NULL));
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_STRING("Page-0-latched", h->data, "forced page was written whole");
+  CHECK(unpinPage(bm, h));
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test a pool split into partitions: statistics cover all partitions and concurrent clients do not lose updates
+void
+testPartitionedPool (void)
+{
+  int i, total = 0, pinnedFrames = 0, found = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *first = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { 0 };
+  pthread_t clients[CONCURRENT_CLIENTS];
+  testName = "Testing partitioned pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+
+  // more partitions than frames are rejected
+  options.numPartitions = 11;
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options), "more partitions than frames");
+
+  options.numPartitions = 4;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options));
+  ASSERT_EQUALS_INT(0, getNumReadIO(bm), "no page read yet");
+
+  // pages of different partitions are reported in the frame contents of the whole pool
+  CHECK(pinPage(bm, first, 0));
+  CHECK(pinPage(bm, h, 1));
+  CHECK(pinPage(bm, h, 1));
+  ASSERT_EQUALS_INT(2, getNumReadIO(bm), "second pin of a page is a hit");
+
+  PageNumber *contents = getFrameContents(bm);
+  int *fixCounts = getFixCounts(bm);
+  for (i = 0; i < 10; i++)
+    {
+      if (contents[i] == 0 || contents[i] == 1)
+        found++;
+      pinnedFrames += fixCounts[i];
+    }
+  ASSERT_EQUALS_INT(2, found, "both pages are in the pool");
+  ASSERT_EQUALS_INT(3, pinnedFrames, "fix counts of all partitions");
+  free(contents);
+  free(fixCounts);
+
+  CHECK(markDirty(bm, first));
+  CHECK(unpinPage(bm, first));
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "one dirty page written");
+
+  for (i = 0; i < CONCURRENT_CLIENTS; i++)
+    pthread_create(&clients[i], NULL, incrementPageCounters, bm);
+  for (i = 0; i < CONCURRENT_CLIENTS; i++)
+    pthread_join(clients[i], NULL);
+  CHECK(shutdownBufferPool(bm));
+
+  // read the counters back through a fresh pool
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_FIFO, NULL));
+  for (i = 0; i < CONCURRENT_PAGES; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      total += *(int *) h->data;
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(CONCURRENT_CLIENTS * CONCURRENT_INCREMENTS, total, "check that no increment was lost");
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(first);
+  TEST_DONE();
+}
+
+// test that the background writer cleans dirty unpinned pages, so that pinPage evicts clean pages only
+void
+testBackgroundWriter (void)
+{
+  int i, numDirty = 0;
+  long waits = 0;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { 0 };
+  testName = "Testing background writer";
+
+  CHECK(createPageFile("testbuffer.bin"));
+
+  options.cleanFramesPercent = 101;
+  ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 5, RS_LRU, NULL, &options), "percentage above 100");
+
+  // the writer stops once enough frames are clean, asking for all of them makes it write every page
+  options.cleanFramesPercent = 100;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 5, RS_LRU, NULL, &options));
+
+  // fill the pool with dirty pages
+  for (i = 0; i < 5; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+
+  // the writer runs on its own, wait until it wrote every page
+  while (getNumWriteIO(bm) < 5 && waits++ < 100000000L)
+    sched_yield();
+  ASSERT_EQUALS_INT(5, getNumWriteIO(bm), "background writer wrote the dirty pages");
+
+  bool *dirty = getDirtyFlags(bm);
+  for (i = 0; i < 5; i++)
+    numDirty += dirty[i];
+  ASSERT_EQUALS_INT(0, numDirty, "no dirty page left");
+  free(dirty);
+
+  // evicting clean pages needs no write
+  for (i = 5; i < 10; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(5, getNumWriteIO(bm), "no write while evicting");
+  CHECK(shutdownBufferPool(bm));
+
+  // the pages reached the page file
+  checkDummyPages(bm, 5);
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// wait until the pool read numReads pages, the prefetcher reads in the background
+static void
+waitForReads (BM_BufferPool *bm, int numReads)
+{
+  long waits = 0;
+  while (getNumReadIO(bm) < numReads && waits++ < 100000000L)
+    sched_yield();
+}
+
+// test prefetch hints and the read-ahead of adjacent pages
+void
+testPrefetch (void)
+{
+  int i;
+  char expected[32];
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { 0 };
+  testName = "Testing prefetch";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 10, RS_LRU, NULL));
+  ASSERT_ERROR(prefetchPages(bm, -1, 2), "negative page number");
+
+  // prefetched pages are hits
+  CHECK(prefetchPages(bm, 2, 4));
+  waitForReads(bm, 4);
+  for (i = 2; i < 6; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "prefetched page content");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "pins of prefetched pages are hits");
+
+  // pages behind the end of the file are not prefetched
+  CHECK(prefetchPages(bm, 18, 4));
+  waitForReads(bm, 6);
+  CHECK(pinPage(bm, h, 18));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 19));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "only the pages of the file are prefetched");
+  CHECK(shutdownBufferPool(bm));
+
+  // the third adjacent pin starts a read-ahead
+  options.readAheadPages = 4;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  waitForReads(bm, 7);
+  ASSERT_EQUALS_INT(7, getNumReadIO(bm), "next pages are read ahead");
+  for (i = 3; i < 7; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "read ahead page content");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that a bulk operation with an access strategy recycles the frames of its ring instead of evicting other pages
+void
+testAccessStrategy (void)
+{
+  int i, numHot = 0;
+  char expected[32];
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_AccessStrategy access;
+  testName = "Testing access strategy";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  ASSERT_ERROR(initAccessStrategy(&access, 0), "empty ring");
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 6, RS_LRU, NULL));
+
+  // the hot set of other clients
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+
+  // a bulk load of 20 pages through a ring of 2 frames
+  CHECK(initAccessStrategy(&access, 2));
+  for (i = 10; i < 30; i++)
+    {
+      CHECK(pinPageWithStrategy(bm, h, i, &access));
+      sprintf(h->data, "%s-%i", "Page", h->pageNum);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(freeAccessStrategy(&access));
+
+  PageNumber *contents = getFrameContents(bm);
+  for (i = 0; i < 6; i++)
+    if (contents[i] >= 0 && contents[i] < 3)
+      numHot++;
+  ASSERT_EQUALS_INT(3, numHot, "hot pages stay in the pool");
+  free(contents);
+  ASSERT_EQUALS_INT(23, getNumReadIO(bm), "every page was read once");
+  ASSERT_EQUALS_INT(18, getNumWriteIO(bm), "recycled dirty frames were written back");
+  CHECK(shutdownBufferPool(bm));
+
+  // a scan that prefetches the next page through a ring of 4 frames
+  CHECK(initBufferPool(bm, "testbuffer.bin", 8, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(initAccessStrategy(&access, 4));
+  for (i = 10; i < 30; i++)
+    {
+      CHECK(prefetchPagesWithStrategy(bm, i + 1, 1, &access));
+      CHECK(pinPageWithStrategy(bm, h, i, &access));
+      sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "scanned page content");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(freeAccessStrategy(&access));
+
+  numHot = 0;
+  contents = getFrameContents(bm);
+  for (i = 0; i < 8; i++)
+    if (contents[i] >= 0 && contents[i] < 3)
+      numHot++;
+  ASSERT_EQUALS_INT(3, numHot, "prefetched pages stay in the ring");
+  free(contents);
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// sum of the fix counts of all frames
+static int
+totalFixCount (BM_BufferPool *bm)
+{
+  int i, total = 0;
+  int *fixCounts = getFixCounts(bm);
+  for (i = 0; i < bm->numPages; i++)
+    total += fixCounts[i];
+  free(fixCounts);
+  return total;
+}
+
+// test pinning and unpinning several pages with one call
+void
+testBatchPinning (void)
+{
+  int i;
+  char expected[32];
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle handles[7];
+  PageNumber misses[] = { 0, 1, 2, 3 };
+  PageNumber mixed[] = { 2, 3, 4 };
+  PageNumber duplicates[] = { 6, 6 };
+  PageNumber hits[] = { 1, 2, 3, 4 };
+  PageNumber tooMany[] = { 8, 9 };
+  PageNumber negative[] = { 7, -1 };
+  testName = "Testing batch pinning";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 5, RS_FIFO, NULL));
+
+  // misses are read together
+  CHECK(pinPages(bm, handles, misses, 4));
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "one read per miss");
+  for (i = 0; i < 4; i++)
+    {
+      sprintf(expected, "%s-%i", "Page", misses[i]);
+      ASSERT_EQUALS_STRING(expected, handles[i].data, "pinned page content");
+    }
+
+  // hits and misses in one call
+  CHECK(pinPages(bm, handles + 4, mixed, 3));
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "hits are not read");
+  ASSERT_EQUALS_INT(7, totalFixCount(bm), "every handle pins its page");
+  CHECK(unpinPages(bm, handles, 7));
+  ASSERT_EQUALS_INT(0, totalFixCount(bm), "all pages unpinned");
+
+  // a page asked for twice is read once and pinned twice
+  CHECK(pinPages(bm, handles, duplicates, 2));
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "duplicate page read once");
+  ASSERT_EQUALS_INT(2, totalFixCount(bm), "duplicate page pinned twice");
+  CHECK(unpinPages(bm, handles, 2));
+
+  // if one page cannot be pinned none stays pinned
+  CHECK(pinPages(bm, handles, hits, 4));
+  ASSERT_ERROR(pinPages(bm, handles + 4, tooMany, 2), "not enough unpinned frames");
+  ASSERT_EQUALS_INT(4, totalFixCount(bm), "failed batch released its pages");
+  CHECK(unpinPages(bm, handles, 4));
+  ASSERT_ERROR(unpinPages(bm, handles + 4, 1), "page not pinned by the failed batch");
+
+  // negative page numbers are rejected before any frame is taken
+  ASSERT_EQUALS_INT(RC_READ_NON_EXISTING_PAGE, pinPages(bm, handles, negative, 2), "negative page number in a batch");
+  ASSERT_EQUALS_INT(NO_PAGE, handles[0].pageNum, "no page pinned by the rejected batch");
+  ASSERT_EQUALS_INT(RC_READ_NON_EXISTING_PAGE, pinPage(bm, handles, NO_PAGE), "negative page number");
+  ASSERT_EQUALS_INT(0, totalFixCount(bm), "no frame taken for negative page numbers");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  TEST_DONE();
+}
+
+// creates an LRU-K pool on testbuffer.bin, k is passed from this function's stack
+static RC
+initLRUKPool (BM_BufferPool *bm, int numPages, int k)
+{
+  return initBufferPool(bm, "testbuffer.bin", numPages, RS_LRU_K, &k);
+}
+
+// test growing and shrinking a pool that has pages pinned
+void
+testResizePool (void)
+{
+  int i;
+  char expected[32];
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PageHandle *pinned = MAKE_PAGE_HANDLE();
+  BM_PageHandle handles[3];
+  BM_PoolOptions options = { 0 };
+  testName = "Testing resizing a pool";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+
+  // page 0 stays pinned through every resize, page 2 is modified
+  CHECK(pinPage(bm, pinned, 0));
+  SM_PageHandle pinnedData = pinned->data;
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 2));
+  sprintf(h->data, "%s", "Page-2-modified");
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+
+  // a grown pool holds more pages without evicting any
+  CHECK(resizeBufferPool(bm, 8));
+  ASSERT_EQUALS_INT(8, bm->numPages, "pool grown");
+  for (i = 3; i < 8; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(8, getNumReadIO(bm), "one read per page");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "no page evicted");
+  ASSERT_EQUALS_INT(1, totalFixCount(bm), "pinned page kept");
+
+  // a shrink writes the dirty pages back and keeps the pinned page where the client reads it
+  ASSERT_ERROR(resizeBufferPool(bm, 0), "a pool without frames");
+  CHECK(resizeBufferPool(bm, 2));
+  ASSERT_EQUALS_INT(2, bm->numPages, "pool shrunk");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "dirty page written before its frame was dropped");
+  ASSERT_TRUE(pinned->data == pinnedData, "buffer of the pinned page did not move");
+  ASSERT_EQUALS_STRING("Page-0", pinned->data, "pinned page content");
+  CHECK(pinPage(bm, h, 0));
+  ASSERT_EQUALS_INT(8, getNumReadIO(bm), "pinned page is still a hit");
+  CHECK(unpinPage(bm, h));
+  CHECK(unpinPage(bm, pinned));
+
+  // the shrunk pool replaces pages as usual
+  for (i = 0; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      if (i == 2)
+        sprintf(expected, "%s", "Page-2-modified");
+      else
+        sprintf(expected, "%s-%i", "Page", i);
+      ASSERT_EQUALS_STRING(expected, h->data, "page content after the shrink");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+
+  // a shrink fails while too many frames are pinned and leaves the pool as it was
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  for (i = 0; i < 3; i++)
+    CHECK(pinPage(bm, &handles[i], i));
+  ASSERT_ERROR(resizeBufferPool(bm, 2), "every frame is pinned");
+  ASSERT_EQUALS_INT(3, bm->numPages, "pool not resized");
+  ASSERT_EQUALS_INT(3, totalFixCount(bm), "pages still pinned");
+  for (i = 0; i < 3; i++)
+    CHECK(unpinPage(bm, &handles[i]));
+  CHECK(resizeBufferPool(bm, 2));
+  CHECK(shutdownBufferPool(bm));
+
+  // the pages keep their recency across a grow: page 1, not page 0 in the first frame, is the least recently used
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+  CHECK(resizeBufferPool(bm, 4));
+  for (i = 3; i < 5; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "most recently used page kept");
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "least recently used page evicted");
+  CHECK(shutdownBufferPool(bm));
+
+  // the pages keep their reference history across a shrink: page 1 was referenced twice, page 2 only once.
+  // K lived on the stack of the function that created the pool, the resized states keep it nevertheless.
+  CHECK(initLRUKPool(bm, 4, 2));
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  CHECK(resizeBufferPool(bm, 3));
+  CHECK(pinPage(bm, h, 4));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 1));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(5, getNumReadIO(bm), "page with k references kept");
+  CHECK(pinPage(bm, h, 2));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "page with fewer references evicted");
+  CHECK(shutdownBufferPool(bm));
+
+  // every partition of a partitioned pool gets its share of the frames
+  options.numPartitions = 2;
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 4, RS_CLOCK, NULL, &options));
+  ASSERT_ERROR(resizeBufferPool(bm, 1), "fewer frames than partitions");
+  CHECK(resizeBufferPool(bm, 7));
+  for (i = 0; i < 20; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      sprintf(expected, "%s-%i", "Page", i);
+      if (i != 2)
+        ASSERT_EQUALS_STRING(expected, h->data, "page content in the grown partitions");
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  free(pinned);
+  TEST_DONE();
+}
+
+// test that a pool reads the pages listed at the last shutdown in the background
+void
+testWarmStart (void)
+{
+  int i, found = 0;
+  char expected[32];
+  PageNumber firstListed = NO_PAGE;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { 0 };
+  PageNumber hotPages[] = { 4, 5, 6, 12 };
+  FILE *warmStartFile;
+  testName = "Testing warm start";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 20);
+  remove("testbuffer.warm");
+
+  // without a list the pool starts cold, the pages in it are listed at shutdown, the most recently used first
+  options.warmStartFile = "testbuffer.warm";
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options));
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, hotPages[i]));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "cold start reads every page");
+  CHECK(shutdownBufferPool(bm));
+
+  warmStartFile = fopen("testbuffer.warm", "r");
+  ASSERT_TRUE(warmStartFile != NULL, "pages listed at shutdown");
+  if (warmStartFile != NULL)
+    {
+      if (fscanf(warmStartFile, "%d", &firstListed) != 1)
+        firstListed = NO_PAGE;
+      fclose(warmStartFile);
+    }
+  ASSERT_EQUALS_INT(5, firstListed, "most recently used page listed first");
+
+  // the listed pages are read in the background, pinning them is a hit
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 10, RS_LRU, NULL, &options));
+  waitForReads(bm, 4);
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, hotPages[i]));
+      sprintf(expected, "%s-%i", "Page", hotPages[i]);
+      ASSERT_EQUALS_STRING(expected, h->data, "warm page content");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "pins of warm pages are hits");
+  CHECK(shutdownBufferPool(bm));
+
+  // a smaller pool only reads the most recently used pages
+  CHECK(initBufferPoolWithOptions(bm, "testbuffer.bin", 2, RS_LRU, NULL, &options));
+  waitForReads(bm, 2);
+  ASSERT_EQUALS_INT(2, getNumReadIO(bm), "one page per frame");
+  PageNumber *contents = getFrameContents(bm);
+  for (i = 0; i < 2; i++)
+    if (contents[i] == 12 || contents[i] == 6)
+      found++;
+  ASSERT_EQUALS_INT(2, found, "most recently used pages read");
+  free(contents);
+  CHECK(shutdownBufferPool(bm));
+
+  remove("testbuffer.warm");
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// sum of the buckets of a latency histogram
+static long
+sumLatency (long *histogram)
+{
+  long sum = 0;
+  int i;
+  for (i = 0; i < BM_LATENCY_BUCKETS; i++)
+    sum += histogram[i];
+  return sum;
+}
+
+// test the statistics returned by getPoolStats
+void
+testPoolStats (void)
+{
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolStats stats;
+  testName = "Testing pool statistics";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+
+  bm->mgmtData = NULL;
+  ASSERT_ERROR(getPoolStats(bm, &stats), "statistics of a pool that is not initialized");
+
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_LONG(0, stats.hits + stats.misses + stats.numReadIO, "new pool has no statistics");
+
+  // three misses, page 0 is changed, then one hit
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, i));
+      if (i == 0)
+        CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+
+  // page 3 replaces the dirty page 0
+  CHECK(pinPage(bm, h, 3));
+  CHECK(unpinPage(bm, h));
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_LONG(1, stats.hits, "hits");
+  ASSERT_EQUALS_LONG(4, stats.misses, "misses");
+  ASSERT_EQUALS_LONG(1, stats.evictions, "evictions");
+  ASSERT_EQUALS_LONG(1, stats.dirtyWriteBacks, "dirty write-backs");
+  ASSERT_EQUALS_LONG(0, stats.flushedPages, "nothing flushed yet");
+
+  // flushing a dirty page
+  CHECK(pinPage(bm, h, 2));
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  CHECK(forceFlushPool(bm));
+
+  // a prefetched page is a prefetch hit when it is pinned
+  CHECK(prefetchPages(bm, 5, 1));
+  waitForReads(bm, 5);
+  CHECK(pinPage(bm, h, 5));
+  CHECK(unpinPage(bm, h));
+
+  CHECK(getPoolStats(bm, &stats));
+  ASSERT_EQUALS_LONG(1, stats.flushedPages, "flushed pages");
+  ASSERT_EQUALS_LONG(1, stats.prefetchedPages, "prefetched pages");
+  ASSERT_EQUALS_LONG(1, stats.prefetchHits, "prefetch hits");
+  ASSERT_EQUALS_LONG(stats.misses, stats.numReadIO, "one read per miss, the prefetched page is not counted");
+  ASSERT_EQUALS_LONG(getNumReadIO(bm), stats.numReadIO + stats.prefetchedPages, "reads as getNumReadIO");
+  ASSERT_EQUALS_LONG(getNumWriteIO(bm), stats.numWriteIO, "writes as getNumWriteIO");
+  ASSERT_EQUALS_LONG(stats.numReadIO + stats.prefetchedPages, sumLatency(stats.readLatency), "every read in the read latency histogram");
+  ASSERT_EQUALS_LONG(stats.numWriteIO, sumLatency(stats.writeLatency), "every write in the write latency histogram");
+  ASSERT_EQUALS_LONG(0, stats.pinWaits, "single client never waits");
+  CHECK(shutdownBufferPool(bm));
+
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test pools on page files with pages of 16 KB and 1 KB, the frames take the page size of the file
+void
+testPageSizes (void)
+{
+  int i, k;
+  int pageSizes[] = { 16384, 1024 };
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  BM_PoolOptions options = { .directIO = true };
+  SM_FileFormat format = { 0 };
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing page sizes other than 4 KB";
+
+  for (k = 0; k < 2; k++)
+    {
+      format.pageSize = pageSizes[k];
+      CHECK(createPageFileWithFormat("testbuffer.bin", &format));
+      CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU, NULL));
+      ASSERT_EQUALS_INT(pageSizes[k], bm->pageSize, "pool takes the page size of the file");
+
+      // fill the first and the last byte of every page, evicting the frames writes them back
+      for (i = 0; i < 10; i++)
+        {
+          CHECK(pinPage(bm, h, i));
+          sprintf(h->data, "%s-%i", "Page", h->pageNum);
+          h->data[bm->pageSize - 1] = 'A' + i;
+          CHECK(markDirty(bm, h));
+          CHECK(unpinPage(bm, h));
+        }
+      CHECK(shutdownBufferPool(bm));
+
+      CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_CLOCK, NULL));
+      for (i = 9; i >= 0; i--)
+        {
+          CHECK(pinPage(bm, h, i));
+          sprintf(expected, "%s-%i", "Page", h->pageNum);
+          ASSERT_EQUALS_STRING(expected, h->data, "start of the page read back");
+          ASSERT_TRUE(h->data[bm->pageSize - 1] == 'A' + i, "last byte of the page read back");
+          CHECK(unpinPage(bm, h));
+        }
+      ASSERT_EQUALS_INT(10, getNumReadIO(bm), "every page read once");
+      CHECK(shutdownBufferPool(bm));
+
+      // O_DIRECT needs pages that are a multiple of its alignment
+      if (pageSizes[k] % SM_DIRECT_IO_ALIGNMENT != 0)
+        ASSERT_ERROR(initBufferPoolWithOptions(bm, "testbuffer.bin", 3, RS_FIFO, NULL, &options), "O_DIRECT pool with 1 KB pages");
+
+      CHECK(destroyPageFile("testbuffer.bin"));
+    }
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test pages that share a bucket of the page table: multiples of 64 collide in the page table of a small pool, so
+// evictions remove pages from the head, the middle and the end of one chain
+void
+testPageTableCollisions (void)
+{
+  const char *poolContents[] = {
+    "[0 0],[64 0],[128 0],[192 0]",
+    // 64 is least recently used and in the middle of the chain
+    "[0 0],[256 0],[128 0],[192 0]",
+    "[0 0],[256 0],[64 1],[192 0]",
+    "[0 0],[256 0],[64x0],[192 0]",
+    // the dirty page is written back when it is removed
+    "[0 0],[256 0],[320 0],[192 0]",
+    "[64 0],[256 0],[320 0],[192 0]"
+  };
+  const int hitRequests[] = {0, 192, 256};
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  char *expected = malloc(sizeof(char) * 512);
+  testName = "Testing colliding pages in the page table";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 384);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 4, RS_LRU, NULL));
+
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, i * 64));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL(poolContents[0], bm, "check pool content after reading colliding pages");
+
+  // all of them are found again without reading them
+  for (i = 0; i < 4; i++)
+    {
+      CHECK(pinPage(bm, h, i * 64));
+      sprintf(expected, "%s-%i", "Page", i * 64);
+      ASSERT_EQUALS_STRING(expected, h->data, "content of a colliding page");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(4, getNumReadIO(bm), "colliding pages are hits");
+
+  // make 64 the least recently used page
+  CHECK(pinPage(bm, h, 0));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 192));
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, 256));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[1], bm, "removing a page from the middle of a chain");
+
+  CHECK(pinPage(bm, h, 64));
+  ASSERT_EQUALS_STRING("Page-64", h->data, "removed page is read again");
+  ASSERT_EQUALS_POOL(poolContents[2], bm, "page read again into the chain");
+  sprintf(h->data, "%s", "Page-64-changed");
+  CHECK(markDirty(bm, h));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[3], bm, "unpinning a colliding page");
+
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, hitRequests[i]));
+      sprintf(expected, "%s-%i", "Page", hitRequests[i]);
+      ASSERT_EQUALS_STRING(expected, h->data, "content of a colliding page");
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_INT(6, getNumReadIO(bm), "remaining pages are still found");
+
+  CHECK(pinPage(bm, h, 320));
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[4], bm, "removing a dirty page from a chain");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "removed dirty page is written back");
+
+  CHECK(pinPage(bm, h, 64));
+  ASSERT_EQUALS_STRING("Page-64-changed", h->data, "changed page is read back");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[5], bm, "page read back into the chain");
+  ASSERT_EQUALS_INT(8, getNumReadIO(bm), "check number of read I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(expected);
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
+
+// test that a dirty page whose write-back fails stays in the pool
+void
+testFailedWriteBack (void)
+{
+  // expected results
+  const char *poolContents[] = {
+    "[5x0],[0x0],[1x0]",
+    "[5x0],[0x0],[2 0]",
+    "[5 0],[0 0],[2 0]"
+  };
+  struct rlimit fileLimit, smallLimit;
+  PageNumber pageNums[] = {5, 0, 1};
+  PageNumber newPage = 2;
+  RC pinResult, pinPagesResult;
+  int i;
+  BM_BufferPool *bm = MAKE_POOL();
+  BM_PageHandle *h = MAKE_PAGE_HANDLE();
+  testName = "Testing failed write-backs";
+
+  CHECK(createPageFile("testbuffer.bin"));
+  createDummyPages(bm, 10);
+  CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_FIFO, NULL));
+
+  for (i = 0; i < 3; i++)
+    {
+      CHECK(pinPage(bm, h, pageNums[i]));
+      sprintf(h->data, "%s-%i-changed", "Page", pageNums[i]);
+      CHECK(markDirty(bm, h));
+      CHECK(unpinPage(bm, h));
+    }
+  ASSERT_EQUALS_POOL(poolContents[0], bm, "check pool content");
+
+  // writes fail while the file size is limited (also those of the test output), reads still work
+  fflush(stdout);
+  signal(SIGXFSZ, SIG_IGN);
+  getrlimit(RLIMIT_FSIZE, &fileLimit);
+  smallLimit = fileLimit;
+  smallLimit.rlim_cur = 0;
+  setrlimit(RLIMIT_FSIZE, &smallLimit);
+  pinResult = pinPage(bm, h, newPage);
+  pinPagesResult = pinPages(bm, h, &newPage, 1);
+  setrlimit(RLIMIT_FSIZE, &fileLimit);
+  signal(SIGXFSZ, SIG_DFL);
+
+  ASSERT_ERROR(pinResult, "page cannot be read if the evicted page cannot be written back");
+  ASSERT_ERROR(pinPagesResult, "pages cannot be read if the evicted page cannot be written back");
+  ASSERT_EQUALS_POOL(poolContents[0], bm, "dirty pages stay in the pool");
+  ASSERT_EQUALS_INT(0, getNumWriteIO(bm), "failed write-backs are not counted");
+
+  CHECK(pinPage(bm, h, 5));
+  ASSERT_EQUALS_STRING("Page-5-changed", h->data, "changed page is still in the pool");
+  CHECK(unpinPage(bm, h));
+  CHECK(pinPage(bm, h, newPage));
+  ASSERT_EQUALS_STRING("Page-2", h->data, "content of the page read");
+  CHECK(unpinPage(bm, h));
+  ASSERT_EQUALS_POOL(poolContents[1], bm, "page read once the write-back works");
+  ASSERT_EQUALS_INT(1, getNumWriteIO(bm), "evicted page is written back");
+  CHECK(forceFlushPool(bm));
+  ASSERT_EQUALS_POOL(poolContents[2], bm, "changed pages are written back");
+  ASSERT_EQUALS_INT(3, getNumWriteIO(bm), "check number of write I/Os");
+
+  CHECK(shutdownBufferPool(bm));
+  CHECK(destroyPageFile("testbuffer.bin"));
+
+  free(bm);
+  free(h);
+  TEST_DONE();
+}
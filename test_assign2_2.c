@@ -32,6 +32,9 @@ free(real);                                \
 static void createDummyPages(BM_BufferPool *bm, int num);
 
 static void testLRU_K (void);
+static void testLRU_KScan (void);
+static void testLFU (void);
+static void testScanResistance (ReplacementStrategy strategy, const char *name);
 
 static void testError (void);
 
@@ -43,6 +46,10 @@ main (void)
     testName = "";
     
     testLRU_K();
+    testLRU_KScan();
+    testLFU();
+    testScanResistance(RS_2Q, "Testing 2Q page replacement with a scan");
+    testScanResistance(RS_ARC, "Testing ARC page replacement with a scan");
     testError();
     return 0;
 }
@@ -144,6 +151,161 @@ testLRU_K (void)
     TEST_DONE();
 }
 
+// test that LRU_K with k = 2 keeps pages used twice while a scan reads pages only once
+void
+testLRU_KScan (void)
+{
+    int i;
+    int k = 2;
+    BM_BufferPool *bm = MAKE_POOL();
+    BM_PageHandle *h = MAKE_PAGE_HANDLE();
+    testName = "Testing LRU_K page replacement with a scan";
+    
+    CHECK(createPageFile("testbuffer.bin"));
+    createDummyPages(bm, 20);
+    CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU_K, &k));
+    
+    // pages 0 and 1 are used twice
+    for(i = 0; i < 4; i++)
+    {
+        CHECK(pinPage(bm, h, i / 2));
+        CHECK(unpinPage(bm, h));
+    }
+    
+    // the scan only replaces its own pages
+    for(i = 2; i < 20; i++)
+    {
+        CHECK(pinPage(bm, h, i));
+        CHECK(unpinPage(bm, h));
+    }
+    ASSERT_EQUALS_POOL("[0 0],[1 0],[19 0]", bm, "check that the scan did not replace pages used twice");
+    
+    // page 18 was evicted only recently and its history was kept, so coming back gives it a second reference.
+    // All pages have two references now and page 0 has the oldest second to last one.
+    CHECK(pinPage(bm, h, 18));
+    CHECK(unpinPage(bm, h));
+    ASSERT_EQUALS_POOL("[0 0],[1 0],[18 0]", bm, "page 19 is replaced by page 18");
+    CHECK(pinPage(bm, h, 17));
+    CHECK(unpinPage(bm, h));
+    ASSERT_EQUALS_POOL("[17 0],[1 0],[18 0]", bm, "page 0 is replaced");
+    
+    CHECK(shutdownBufferPool(bm));
+    
+    // k has to be at least 1
+    k = 0;
+    ASSERT_ERROR(initBufferPool(bm, "testbuffer.bin", 3, RS_LRU_K, &k), "init LRU_K pool with k = 0");
+    CHECK(destroyPageFile("testbuffer.bin"));
+    
+    free(bm);
+    free(h);
+    TEST_DONE();
+}
+
+// test the LFU page replacement strategy
+void
+testLFU (void)
+{
+    int i;
+    BM_BufferPool *bm = MAKE_POOL();
+    BM_PageHandle *h = MAKE_PAGE_HANDLE();
+    testName = "Testing LFU page replacement";
+    
+    CHECK(createPageFile("testbuffer.bin"));
+    createDummyPages(bm, 10);
+    CHECK(initBufferPool(bm, "testbuffer.bin", 3, RS_LFU, NULL));
+    
+    // page 0 is used three times, page 1 twice and page 2 once
+    const int requests[] = {0,0,0,1,1,2};
+    for(i = 0; i < 6; i++)
+    {
+        CHECK(pinPage(bm, h, requests[i]));
+        CHECK(unpinPage(bm, h));
+    }
+    ASSERT_EQUALS_POOL("[0 0],[1 0],[2 0]", bm, "check pool content reading in pages");
+    
+    // the least frequently used page is replaced
+    CHECK(pinPage(bm, h, 3));
+    CHECK(unpinPage(bm, h));
+    ASSERT_EQUALS_POOL("[0 0],[1 0],[3 0]", bm, "page 2 is used least frequently");
+    
+    // page 3 is used three times now, so page 1 is replaced next
+    for(i = 0; i < 2; i++)
+    {
+        CHECK(pinPage(bm, h, 3));
+        CHECK(unpinPage(bm, h));
+    }
+    CHECK(pinPage(bm, h, 4));
+    CHECK(unpinPage(bm, h));
+    ASSERT_EQUALS_POOL("[0 0],[4 0],[3 0]", bm, "page 1 is used least frequently");
+    
+    // a pinned page is not replaced even if it is used least frequently
+    CHECK(pinPage(bm, h, 4));
+    CHECK(pinPage(bm, h, 5));
+    CHECK(unpinPage(bm, h));
+    ASSERT_EQUALS_POOL("[5 0],[4 1],[3 0]", bm, "pinned page 4 is not replaced");
+    h->pageNum = 4;
+    CHECK(unpinPage(bm, h));
+    
+    CHECK(shutdownBufferPool(bm));
+    CHECK(destroyPageFile("testbuffer.bin"));
+    
+    free(bm);
+    free(h);
+    TEST_DONE();
+}
+// test that a scan does not replace the pages that are used repeatedly
+void
+testScanResistance (ReplacementStrategy strategy, const char *name)
+{
+    int i;
+    BM_BufferPool *bm = MAKE_POOL();
+    BM_PageHandle *h = MAKE_PAGE_HANDLE();
+    testName = (char *) name;
+    
+    CHECK(createPageFile("testbuffer.bin"));
+    createDummyPages(bm, 30);
+    CHECK(initBufferPool(bm, "testbuffer.bin", 4, strategy, NULL));
+    
+    // pages 0 and 1 are used, replaced and used twice again
+    const int requests[] = {0,1,2,3,4,5,0,1,0,1};
+    for(i = 0; i < 10; i++)
+    {
+        CHECK(pinPage(bm, h, requests[i]));
+        CHECK(unpinPage(bm, h));
+    }
+    
+    // the scan reads every page once
+    for(i = 10; i < 30; i++)
+    {
+        CHECK(pinPage(bm, h, i));
+        CHECK(unpinPage(bm, h));
+    }
+    ASSERT_EQUALS_POOL("[28 0],[29 0],[0 0],[1 0]", bm, "check that pages 0 and 1 survived the scan");
+    
+    // all frames pinned
+    for(i = 0; i < 2; i++)
+        CHECK(pinPage(bm, h, i));
+    CHECK(pinPage(bm, h, 28));
+    CHECK(pinPage(bm, h, 29));
+    ASSERT_ERROR(pinPage(bm, h, 9), "try to pin page when pool is full of pinned pages");
+    
+    for(i = 0; i < 2; i++)
+    {
+        h->pageNum = i;
+        CHECK(unpinPage(bm, h));
+    }
+    h->pageNum = 28;
+    CHECK(unpinPage(bm, h));
+    h->pageNum = 29;
+    CHECK(unpinPage(bm, h));
+    
+    CHECK(shutdownBufferPool(bm));
+    CHECK(destroyPageFile("testbuffer.bin"));
+    
+    free(bm);
+    free(h);
+    TEST_DONE();
+}
 
 // test error cases
 void
@@ -55,6 +55,8 @@ static void testScans (void);
 static void testScansTwo (void);
 static void testInsertManyRecords(void);
 static void testMultipleScans(void);
+static void testCompressedTable(void);
+static void testPageSizes(void);
 
 // struct for test records
 typedef struct TestRecord {
@@ -84,6 +86,8 @@ main (void)
   testScans();
   testScansTwo();
   testMultipleScans();
+  testCompressedTable();
+  testPageSizes();
 
   return 0;
 }
@@ -415,6 +419,128 @@ testInsertManyRecords(void)
   TEST_DONE();
 }
 
+// ************************************************************ 
+void
+testCompressedTable (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  SM_FileFormat format = { .checksums = true, .compressed = true, .pageSize = 512 };
+  TestRecord update = {0, "aaaa", 1};
+  char b[5];
+  int numInserts = 5000, i;
+  Record *r, *expected;
+  RID *rids;
+  Schema *schema;
+  testName = "test inserting and updating records in a compressed table with small pages";
+  schema = testSchema();
+  rids = (RID *) malloc(sizeof(RID) * numInserts);
+
+  TEST_CHECK(initRecordManager(NULL));
+  TEST_CHECK(createTableWithFormat("test_table_c", schema, &format));
+  TEST_CHECK(openTable(table, "test_table_c"));
+
+  // more pages than the pool has frames, so pages are written and read again; every record is different
+  for(i = 0; i < numInserts; i++)
+    {
+      sprintf(b, "%c%c%c%c", 'a' + i % 26, 'a' + i / 26 % 26, 'a' + i * 7 % 26, 'a' + i * 11 % 26);
+      r = testRecord(schema, i, b, i * 7919);
+      TEST_CHECK(insertRecord(table, r));
+      rids[i] = r->id;
+      freeRecord(r);
+    }
+
+  // all records become the same, the updated pages compress to a few bytes and are rewritten into their old records
+  for(i = 0; i < numInserts; i++)
+    {
+      r = fromTestRecord(schema, update);
+      r->id = rids[i];
+      TEST_CHECK(updateRecord(table, r));
+      freeRecord(r);
+    }
+
+  createRecord(&r, schema);
+  expected = fromTestRecord(schema, update);
+  for(i = 0; i < numInserts; i++)
+    {
+      TEST_CHECK(getRecord(table, rids[i], r));
+      ASSERT_TRUE(memcmp(expected->data, r->data, getRecordSize(schema)) == 0, "updated record read back");
+    }
+  freeRecord(expected);
+
+  TEST_CHECK(closeTable(table));
+  TEST_CHECK(deleteTable("test_table_c"));
+  TEST_CHECK(shutdownRecordManager());
+
+  freeRecord(r);
+  free(rids);
+  free(table);
+  TEST_DONE();
+}
+
+// removes the table of testPageSizes, also when a failed check exits in the middle of the test
+static void
+deletePageSizesTable (void)
+{
+  deleteTable("test_table_p");
+}
+
+void
+testPageSizes (void)
+{
+  RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));
+  int pageSizes[] = { 1024, 65536 };
+  int numInserts = 12000, i, k;
+  char b[5];
+  Record *r, *expected;
+  RID *rids;
+  Schema *schema;
+  testName = "test tables with pages of 1 KB and 64 KB";
+  schema = testSchema();
+  rids = (RID *) malloc(sizeof(RID) * numInserts);
+
+  atexit(deletePageSizesTable);
+
+  TEST_CHECK(initRecordManager(NULL));
+  for(k = 0; k < 2; k++)
+    {
+      TEST_CHECK(createTableWithPageSize("test_table_p", schema, pageSizes[k]));
+      TEST_CHECK(openTable(table, "test_table_p"));
+
+      for(i = 0; i < numInserts; i++)
+        {
+          sprintf(b, "%c%c%c%c", 'a' + i % 26, 'a' + i / 26 % 26, 'a' + i / 676 % 26, 'a' + i / 17576 % 26);
+          r = testRecord(schema, i, b, i % 5);
+          TEST_CHECK(insertRecord(table, r));
+          rids[i] = r->id;
+          freeRecord(r);
+        }
+      ASSERT_EQUALS_INT(numInserts, getNumTuples(table), "number of tuples");
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(openTable(table, "test_table_p"));
+
+      // several pages even with 64 KB, every record is found again at its RID
+      createRecord(&r, schema);
+      for(i = 0; i < numInserts; i++)
+        {
+          sprintf(b, "%c%c%c%c", 'a' + i % 26, 'a' + i / 26 % 26, 'a' + i / 676 % 26, 'a' + i / 17576 % 26);
+          expected = testRecord(schema, i, b, i % 5);
+          TEST_CHECK(getRecord(table, rids[i], r));
+          ASSERT_TRUE(memcmp(expected->data, r->data, getRecordSize(schema)) == 0, "record read back at its RID");
+          freeRecord(expected);
+        }
+      freeRecord(r);
+
+      TEST_CHECK(closeTable(table));
+      TEST_CHECK(deleteTable("test_table_p"));
+    }
+  TEST_CHECK(shutdownRecordManager());
+
+  free(rids);
+  free(table);
+  TEST_DONE();
+}
+
 void testScans (void)
 {
   RM_TableData *table = (RM_TableData *) malloc(sizeof(RM_TableData));